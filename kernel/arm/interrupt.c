@@ -0,0 +1,260 @@
+/** @file interrupt.c
+ *
+ * @brief Table-driven dispatch of the PXA255 interrupt sources.
+ *
+ * Every source has a slot in int_handlers and is masked in ICMR until a
+ * handler is installed for it.  One IRQ entry services every source that
+ * is pending: ICIP is read, the source with the highest software priority
+ * (ties broken by source number, with count-leading-zeros) is handled, and
+ * ICIP is read again until it is clear.  Handlers acknowledge their own
+ * hardware; work that does not have to be done masked should be posted
+ * with defer_post.
+ *
+ * The PXA255 controller has no priorities of its own, so they are made with
+ * ICMR: while a handler runs, only sources of strictly higher priority stay
+ * unmasked and the CPU takes IRQs again.  Such an interrupt nests -- its
+ * registers go on the SVC stack below ours -- and returns to the handler
+ * it preempted.  Sources at INT_PRIO_HIGH have nothing above them and run
+ * masked.  Deferred work only runs once the outermost level is done, still
+ * counted as a level, and a task it woke is dispatched after it.
+ */
+
+#include <types.h>
+#include <assert.h>
+#include <exports.h>
+#include <defer.h>
+#include <crit.h>
+#include <arm/reg.h>
+#include <arm/psr.h>
+#include <arm/exception.h>
+#include <arm/interrupt.h>
+#include <section.h>
+
+static void (*int_handlers[NUM_INTERRUPTS])(unsigned int int_num);
+static uint8_t int_prio[NUM_INTERRUPTS];
+
+static uint32_t int_srcs[INT_PRIO_LEVELS];   /* sources at each priority */
+static uint32_t int_above[INT_PRIO_LEVELS];  /* sources above each priority */
+static uint32_t int_enabled;   /* sources with a handler and not masked */
+static uint32_t int_allowed;   /* sources above the handler now running */
+static uint32_t int_fiq;       /* sources routed to FIQ, never masked */
+static unsigned int irq_nest;  /* handler levels active */
+
+static void icmr_update(void)
+{
+	reg_write(INT_ICMR_ADDR, (int_enabled & int_allowed) | int_fiq);
+}
+
+/* mask IRQs, returning the previous CPSR for int_restore */
+static inline uint32_t int_save(void)
+{
+	uint32_t cpsr = read_cpsr();
+
+	disable_interrupts();
+	return cpsr;
+}
+
+static inline void int_restore(uint32_t cpsr)
+{
+	asm volatile ("msr cpsr_c, %0" : : "r" (cpsr) : "memory", "cc");
+}
+
+/* the pending source to serve first */
+static unsigned int int_pick(uint32_t pending)
+{
+	unsigned int prio;
+
+	for(prio = INT_PRIO_LEVELS - 1; prio > 0; prio--)
+		if(pending & int_srcs[prio])
+			break;
+	return 31 - __builtin_clz(pending & int_srcs[prio]);
+}
+
+/**
+ * @brief Masks and routes to IRQ every source and forgets every handler.
+ */
+void init_interrupt(void)
+{
+	unsigned int i;
+
+	reg_write(INT_ICMR_ADDR, 0);
+	reg_write(INT_ICLR_ADDR, 0);
+	for(i = 0; i < NUM_INTERRUPTS; i++) {
+		int_handlers[i] = NULL;
+		int_prio[i] = INT_PRIO_LOW;
+	}
+	for(i = 0; i < INT_PRIO_LEVELS; i++) {
+		int_srcs[i] = 0;
+		int_above[i] = 0;
+	}
+	int_srcs[INT_PRIO_LOW] = ~0u;
+	int_enabled = 0;
+	int_allowed = ~0u;
+	int_fiq = 0;
+	irq_nest = 0;
+}
+
+/**
+ * @brief Masks every source again.
+ */
+void destroy_interrupt(void)
+{
+	int_enabled = 0;
+	int_fiq = 0;
+	reg_write(INT_ICMR_ADDR, 0);
+}
+
+/**
+ * @brief Sets the priority of source int_num, INT_PRIO_LOW (the default)
+ * to INT_PRIO_HIGH.  A running handler is preempted by higher ones only.
+ */
+void int_set_prio(unsigned int int_num, unsigned int prio)
+{
+	uint32_t cpsr;
+	unsigned int i, j;
+
+	if(int_num >= NUM_INTERRUPTS || prio >= INT_PRIO_LEVELS)
+		interrupt_panic(int_num);
+
+	cpsr = int_save();
+	int_srcs[int_prio[int_num]] &= ~(1u << int_num);
+	int_srcs[prio] |= 1u << int_num;
+	int_prio[int_num] = prio;
+	for(i = 0; i < INT_PRIO_LEVELS; i++) {
+		int_above[i] = 0;
+		for(j = i + 1; j < INT_PRIO_LEVELS; j++)
+			int_above[i] |= int_srcs[j];
+	}
+	int_restore(cpsr);
+}
+
+/**
+ * @brief Installs the handler for source int_num and unmasks the source.
+ */
+void install_int_handler(unsigned int int_num, void (*int_handler)(unsigned int))
+{
+	uint32_t cpsr;
+
+	if(int_num >= NUM_INTERRUPTS || (INT_RESERVED_MASK & (1u << int_num)))
+		interrupt_panic(int_num);
+
+	cpsr = int_save();
+	int_handlers[int_num] = int_handler;
+	reg_clear(INT_ICLR_ADDR, 1u << int_num);
+	int_enabled |= 1u << int_num;
+	icmr_update();
+	int_restore(cpsr);
+}
+
+/**
+ * @brief Routes source int_num to FIQ and unmasks it.  Its handler is
+ * whatever sits on the FIQ vector; IRQ priorities do not apply to it.
+ */
+void install_fiq_source(unsigned int int_num)
+{
+	uint32_t cpsr;
+
+	if(int_num >= NUM_INTERRUPTS || (INT_RESERVED_MASK & (1u << int_num)))
+		interrupt_panic(int_num);
+
+	cpsr = int_save();
+	reg_set(INT_ICLR_ADDR, 1u << int_num);
+	int_fiq |= 1u << int_num;
+	icmr_update();
+	int_restore(cpsr);
+}
+
+/**
+ * @brief Masks source int_num, e.g. while its driver drains a FIFO.
+ */
+void int_mask(unsigned int int_num)
+{
+	uint32_t cpsr = int_save();
+
+	int_enabled &= ~(1u << int_num);
+	icmr_update();
+	int_restore(cpsr);
+}
+
+/**
+ * @brief Unmasks source int_num again.
+ */
+void int_unmask(unsigned int int_num)
+{
+	uint32_t cpsr = int_save();
+
+	int_enabled |= 1u << int_num;
+	icmr_update();
+	int_restore(cpsr);
+}
+
+/**
+ * @brief Dispatches until no unmasked source is pending.
+ *
+ * Entered with IRQs masked from irq_wrapper, possibly nested inside a
+ * lower-priority handler, and returns with them masked.
+ */
+HOT void irq_handler(void)
+{
+	uint32_t pending, allowed;
+	unsigned int num;
+
+	defer_irq_enter();
+	irq_nest++;
+
+	while((pending = reg_read(INT_ICIP_ADDR)) != 0) {
+		num = int_pick(pending);
+		if(int_handlers[num] == NULL)
+			interrupt_panic(num);
+
+		allowed = int_allowed;
+		int_allowed = int_above[int_prio[num]];
+		if(int_allowed == 0) {
+			int_handlers[num](num);
+		} else {
+			icmr_update();
+			defer_irq_leave();
+			enable_interrupts();
+			int_handlers[num](num);
+			disable_interrupts();
+			defer_irq_enter();
+		}
+		int_allowed = allowed;
+		icmr_update();
+	}
+
+	/*
+	 * run the deferred work with interrupts enabled once no handler is
+	 * left to return to, and preempt the interrupted task once it is done
+	 */
+	if(irq_nest == 1)
+		defer_run();
+	else
+		defer_irq_leave();
+	if(--irq_nest == 0)
+		crit_irq_return();
+}
+
+/**
+ * @brief Whether an interrupt handler or deferred work is running.
+ */
+HOT int in_interrupt(void)
+{
+	return irq_nest != 0;
+}
+
+/**
+ * @brief Asks for a dispatch before the interrupt returns.
+ */
+void request_reschedule(void)
+{
+	crit_preempt();
+}
+
+/**
+ * @brief Called for a source that is pending but has no handler.
+ */
+COLD void interrupt_panic(unsigned int int_num)
+{
+	panic("unhandled interrupt source %u\n", int_num);
+}
@@ -1,4 +1,4 @@
-ARM_OBJS := reg.o psr.o int_asm.o
+ARM_OBJS := reg.o psr.o int_asm.o interrupt.o mmu.o
 ARM_OBJS := $(ARM_OBJS:%=$(KDIR)/arm/%)
 
 KOBJS += $(ARM_OBJS)
@@ -0,0 +1,212 @@
+/** @file mmu.c
+ *
+ * @brief Turns on the MMU, caches and write buffer, and maintains the caches.
+ *
+ * U-Boot starts the kernel with the MMU and D-cache off, so there is nothing
+ * dirty to save when they are turned on.  On the way back to U-Boot every
+ * line of SDRAM is cleaned and the control register is put back the way
+ * U-Boot left it.
+ *
+ * CP15 writes on the XScale only take effect once the pipeline drains, which
+ * is what cpwait waits for.
+ */
+
+#include <types.h>
+#include <exports.h>
+#include <arm/physmem.h>
+#include <arm/mmu.h>
+#include <bits/time_page.h>
+
+/* One word per 1MB section, aligned as the TTB needs */
+static uint32_t page_table[MMU_SECTIONS] __attribute__((aligned(16384)));
+
+/* 4KB pages of the section that holds the time page */
+static uint32_t time_page_table[MMU_COARSE_ENTRIES] __attribute__((aligned(1024)));
+
+static uint32_t boot_ctrl;  /* control register as U-Boot left it */
+static int mmu_on;
+
+static inline uint32_t cp15_ctrl_read(void)
+{
+	uint32_t ctrl;
+	asm volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (ctrl));
+	return ctrl;
+}
+
+static inline void cpwait(void)
+{
+	uint32_t tmp;
+	asm volatile ("mrc p15, 0, %0, c2, c0, 0\n\t"
+	              "mov %0, %0\n\t"
+	              "sub pc, pc, #4"
+	              : "=r" (tmp) : : "memory");
+}
+
+static inline void drain_write_buffer(void)
+{
+	asm volatile ("mcr p15, 0, %0, c7, c10, 4" : : "r" (0) : "memory");
+}
+
+/*
+ * Maps the section holding the time page with 4KB pages, all of them like
+ * the rest of SDRAM but the time page, which tasks may only read.
+ */
+static void map_time_page(void)
+{
+	uint32_t sect = TIME_PAGE_ADDR & ~((1u << MMU_SECTION_SHIFT) - 1);
+	uint32_t addr;
+	unsigned int i;
+
+	for(i = 0; i < MMU_COARSE_ENTRIES; i++) {
+		addr = sect + (i << MMU_PAGE_SHIFT);
+		if(addr == TIME_PAGE_ADDR)
+			time_page_table[i] = addr | MMU_PAGE_USER_RO;
+		else
+			time_page_table[i] = addr | MMU_PAGE_CACHED;
+	}
+	page_table[sect >> MMU_SECTION_SHIFT] = (uint32_t)time_page_table
+	                                        | MMU_COARSE;
+}
+
+/**
+ * @brief Maps memory flat, cached for SDRAM and uncached elsewhere, and
+ * enables the MMU, both caches, the write buffer and branch prediction.
+ * The time page is read-only to user mode.
+ *
+ * @return 0 on success, -1 if the MMU was already on.
+ */
+int mmu_init(void)
+{
+	uint32_t addr, ctrl;
+	unsigned int i;
+
+	boot_ctrl = cp15_ctrl_read();
+	if(boot_ctrl & CP15_CTRL_M) {
+		printf("MMU already enabled, leaving the caches as they are\n");
+		return -1;
+	}
+
+	for(i = 0; i < MMU_SECTIONS; i++) {
+		addr = i << MMU_SECTION_SHIFT;
+		if(addr >= RAM_START_ADDR && addr < RAM_END_ADDR)
+			page_table[i] = addr | MMU_SECT_CACHED;
+		else
+			page_table[i] = addr | MMU_SECT_UNCACHED;
+	}
+	map_time_page();
+
+	/* start from empty caches and TLBs */
+	drain_write_buffer();
+	asm volatile ("mcr p15, 0, %0, c7, c7, 0\n\t"   /* I, D and BTB */
+	              "mcr p15, 0, %0, c8, c7, 0"       /* I and D TLBs */
+	              : : "r" (0) : "memory");
+
+	asm volatile ("mcr p15, 0, %0, c2, c0, 0\n\t"
+	              "mcr p15, 0, %1, c3, c0, 0"
+	              : : "r" (page_table), "r" (MMU_DACR_CLIENT) : "memory");
+	cpwait();
+
+	ctrl = boot_ctrl | CP15_CTRL_M | CP15_CTRL_C | CP15_CTRL_W
+	       | CP15_CTRL_Z | CP15_CTRL_I;
+	asm volatile ("mcr p15, 0, %0, c1, c0, 0" : : "r" (ctrl) : "memory");
+	cpwait();
+
+	mmu_on = 1;
+	return 0;
+}
+
+/**
+ * @brief Writes back all of SDRAM and returns the MMU and caches to the
+ * state U-Boot left them in.  Called with interrupts masked.
+ *
+ * The clean, the control register write and the invalidates are one block
+ * with no stores in it, so nothing the CPU writes in between is left behind
+ * in the cache.
+ */
+void mmu_disable(void)
+{
+	uint32_t addr, end;
+
+	if(!mmu_on)
+		return;
+
+	addr = RAM_START_ADDR;
+	end = RAM_END_ADDR;
+	asm volatile ("1: mcr p15, 0, %0, c7, c10, 1\n\t"  /* clean D line */
+	              "add %0, %0, %3\n\t"
+	              "cmp %0, %1\n\t"
+	              "bne 1b\n\t"
+	              "mcr p15, 0, %0, c7, c10, 4\n\t"      /* drain write buffer */
+	              "mcr p15, 0, %2, c1, c0, 0\n\t"
+	              "mrc p15, 0, %0, c2, c0, 0\n\t"       /* cpwait */
+	              "mov %0, %0\n\t"
+	              "sub pc, pc, #4\n\t"
+	              "mov %0, #0\n\t"
+	              "mcr p15, 0, %0, c7, c7, 0\n\t"       /* I, D and BTB */
+	              "mcr p15, 0, %0, c8, c7, 0"           /* I and D TLBs */
+	              : "+r" (addr)
+	              : "r" (end), "r" (boot_ctrl), "I" (CACHE_LINE_SIZE)
+	              : "memory", "cc");
+
+	mmu_on = 0;
+}
+
+/**
+ * @brief Writes the lines covering [start, start + len) back to memory,
+ * e.g. before a device reads them.
+ */
+void dcache_clean_range(const void* start, size_t len)
+{
+	uintptr_t addr = (uintptr_t)start & ~(CACHE_LINE_SIZE - 1);
+	uintptr_t end = (uintptr_t)start + len;
+
+	for(; addr < end; addr += CACHE_LINE_SIZE)
+		asm volatile ("mcr p15, 0, %0, c7, c10, 1" : : "r" (addr) : "memory");
+	drain_write_buffer();
+}
+
+/**
+ * @brief Drops the lines covering [start, start + len), e.g. before reading
+ * what a device wrote there.  Lines only partly in the range are written
+ * back first, so data that shares them survives.
+ */
+void dcache_inval_range(void* start, size_t len)
+{
+	uintptr_t addr = (uintptr_t)start;
+	uintptr_t end = addr + len;
+
+	if(addr & (CACHE_LINE_SIZE - 1))
+		asm volatile ("mcr p15, 0, %0, c7, c10, 1" : : "r" (addr) : "memory");
+	if(end & (CACHE_LINE_SIZE - 1))
+		asm volatile ("mcr p15, 0, %0, c7, c10, 1" : : "r" (end) : "memory");
+	drain_write_buffer();
+
+	for(addr &= ~(CACHE_LINE_SIZE - 1); addr < end; addr += CACHE_LINE_SIZE)
+		asm volatile ("mcr p15, 0, %0, c7, c6, 1" : : "r" (addr) : "memory");
+}
+
+/**
+ * @brief Writes back and drops the lines covering [start, start + len).
+ */
+void dcache_flush_range(void* start, size_t len)
+{
+	uintptr_t addr = (uintptr_t)start & ~(CACHE_LINE_SIZE - 1);
+	uintptr_t end = (uintptr_t)start + len;
+
+	for(; addr < end; addr += CACHE_LINE_SIZE)
+		asm volatile ("mcr p15, 0, %0, c7, c10, 1\n\t"
+		              "mcr p15, 0, %0, c7, c6, 1"
+		              : : "r" (addr) : "memory");
+	drain_write_buffer();
+}
+
+/**
+ * @brief Makes instructions just written to [start, start + len) visible
+ * to instruction fetch.  Works with the caches on or off.
+ */
+void icache_sync_range(const void* start, size_t len)
+{
+	dcache_clean_range(start, len);
+	asm volatile ("mcr p15, 0, %0, c7, c5, 0" : : "r" (0) : "memory");
+	cpwait();
+}
@@ -12,15 +12,15 @@
 
 #include <arm/psr.h>
 #include <arm/exception.h>
+#include <section.h>
 
-void panic(const char* fmt, ...)
+COLD void panic(const char* fmt, ...)
 {
 	va_list list;
 
 	va_start(list, fmt);
-	// XXX This is not working... fix it later.
-	//vprintf(fmt, list);
-	printf("PANIC!");
+	printf("PANIC! ");
+	vprintf(fmt, list);
 	va_end(list);
 
 	disable_interrupts();
@@ -0,0 +1,162 @@
+/** @file crit.c
+ *
+ * @brief Nestable critical sections and preemption at their exit.
+ *
+ * A section masks interrupts.  Only the outermost crit_enter records the
+ * CPSR it found, and only the outermost crit_exit puts it back, so a section
+ * entered from a top half or from boot code leaves interrupts masked.
+ *
+ * A wakeup that makes a task above the current one runnable only sets
+ * crit_resched.  Task code acts on it at the end of its outermost section;
+ * the interrupt path acts on it just before the outermost interrupt returns.
+ * Every dispatch picks the highest runnable task, so each one clears it.
+ *
+ * The depth and saved CPSR belong to the task that is running: the
+ * dispatcher saves them on the kernel stack of the task it switches out and
+ * puts them back when that task runs again.
+ */
+
+#include <types.h>
+#include <config.h>
+#include <crit.h>
+#include <sched.h>
+#include <arm/psr.h>
+#include <arm/exception.h>
+#include <arm/interrupt.h>
+#include <arm/timer.h>
+#include <bits/time_page.h>
+#include <section.h>
+
+static unsigned int crit_depth;
+static uint32_t crit_cpsr;     /* CPSR at the outermost crit_enter */
+static int crit_resched;       /* a task above the current one is ready */
+
+static struct time_page* const time_page = (struct time_page*)TIME_PAGE_ADDR;
+
+#if OS_CRIT_TRACE
+static uint64_t crit_start;
+static void* crit_site;
+
+/* the end of a section that started at crit_start */
+static void crit_trace_end(void)
+{
+	uint64_t len = clock_ns() - crit_start;
+
+	if(len > time_page->crit_max_ns) {
+		time_page->crit_max_ns = len;
+		time_page->crit_max_site = (unsigned long)crit_site;
+	}
+}
+#endif
+
+/**
+ * @brief Leaves every section and forgets the trace.  Called once at boot.
+ */
+void crit_init(void)
+{
+	crit_reset();
+	time_page->crit_max_ns = 0;
+	time_page->crit_max_site = 0;
+}
+
+/**
+ * @brief Masks interrupts until the matching crit_exit.
+ */
+HOT void crit_enter(void)
+{
+	uint32_t cpsr = read_cpsr();
+
+	disable_interrupts();
+	if(crit_depth++ == 0) {
+		crit_cpsr = cpsr;
+#if OS_CRIT_TRACE
+		crit_site = __builtin_return_address(0);
+		crit_start = clock_ns();
+#endif
+	}
+}
+
+/**
+ * @brief Leaves a section.  The outermost one dispatches if a higher task
+ * became ready and it was entered preemptible, then restores interrupts.
+ */
+HOT void crit_exit(void)
+{
+	uint32_t cpsr;
+
+	if(--crit_depth != 0)
+		return;
+
+#if OS_CRIT_TRACE
+	crit_trace_end();
+#endif
+	/*
+	 * the dispatch runs at depth 0, so any section entered inside it is
+	 * outermost and overwrites crit_cpsr -- keep our own copy
+	 */
+	cpsr = crit_cpsr;
+	if(crit_resched && !(cpsr & PSR_IRQ) && !in_interrupt()
+	   && get_cur_tcb() != NULL)
+		dispatch_save();
+
+	asm volatile ("msr cpsr_c, %0" : : "r" (cpsr) : "memory", "cc");
+}
+
+/**
+ * @brief Asks for a dispatch at the next preemption point.  Called with
+ * interrupts masked.
+ */
+HOT void crit_preempt(void)
+{
+	crit_resched = 1;
+}
+
+/**
+ * @brief The preemption point of the interrupt path.  Called with
+ * interrupts masked as the outermost interrupt returns.
+ */
+HOT void crit_irq_return(void)
+{
+	if(crit_resched && get_cur_tcb() != NULL)
+		dispatch_save();
+}
+
+/**
+ * @brief Saves the section state of the task being switched out in s.  The
+ * task switched to starts outside any section.
+ */
+HOT void crit_suspend(struct crit_state* s)
+{
+	s->depth = crit_depth;
+	s->cpsr = crit_cpsr;
+#if OS_CRIT_TRACE
+	if(crit_depth != 0)
+		crit_trace_end();
+	s->site = crit_site;
+#endif
+	crit_reset();
+}
+
+/**
+ * @brief Puts back the section state saved by crit_suspend.  Time spent
+ * switched out does not count towards the section.
+ */
+HOT void crit_resume(const struct crit_state* s)
+{
+	crit_depth = s->depth;
+	crit_cpsr = s->cpsr;
+#if OS_CRIT_TRACE
+	crit_site = s->site;
+	crit_start = clock_ns();
+#endif
+}
+
+/**
+ * @brief Leaves every section without touching the CPSR -- for a context
+ * that starts afresh, like a task launched for the first time.
+ */
+HOT void crit_reset(void)
+{
+	crit_depth = 0;
+	crit_resched = 0;
+}
@@ -0,0 +1,134 @@
+/** @file defer.c
+ *
+ * @brief Runs the deferred part of interrupt handling with interrupts on.
+ *
+ * Each source owns one pending byte.  Its top half sets the byte with a
+ * plain store and defer_run takes it back with SWPB, an atomic exchange, so
+ * a post that races with the scan is either seen now or left set for the
+ * next pass -- never lost -- without masking interrupts.  Only the final
+ * check that nothing is pending is made with interrupts masked, which is
+ * what guarantees no work is left behind when defer_run returns.
+ *
+ * The stretches of the interrupt path that run masked are timed with the
+ * OS timer and the longest is published in the time page.
+ */
+
+#include <types.h>
+#include <defer.h>
+#include <arm/timer.h>
+#include <arm/psr.h>
+#include <arm/exception.h>
+#include <bits/time_page.h>
+#include <section.h>
+
+volatile uint8_t defer_pending[DEFER_MAX];
+
+static void (*defer_fn[DEFER_MAX])(void);
+static int defer_active;   /* a defer_run is in progress on this stack */
+static uint64_t irq_off_start;
+
+static struct time_page* const time_page = (struct time_page*)TIME_PAGE_ADDR;
+
+/* atomically fetch *p and clear it */
+static inline uint8_t defer_take(volatile uint8_t* p)
+{
+	uint32_t old;
+
+	asm volatile ("swpb %0, %2, [%1]"
+	              : "=&r" (old) : "r" (p), "r" (0) : "memory");
+	return old;
+}
+
+/* the end of a masked stretch that started at irq_off_start */
+static void irq_off_end(void)
+{
+	uint64_t len = clock_ns() - irq_off_start;
+
+	if(len > time_page->irq_off_max_ns)
+		time_page->irq_off_max_ns = len;
+}
+
+/**
+ * @brief Drops every handler and all pending work.
+ */
+void defer_init(void)
+{
+	unsigned int i;
+
+	for(i = 0; i < DEFER_MAX; i++) {
+		defer_fn[i] = NULL;
+		defer_pending[i] = 0;
+	}
+	defer_active = 0;
+	time_page->irq_off_max_ns = 0;
+}
+
+/**
+ * @brief Sets the handler that runs when src is posted.
+ */
+void defer_register(unsigned int src, void (*fn)(void))
+{
+	defer_fn[src] = fn;
+}
+
+/**
+ * @brief Starts timing a masked part of an interrupt.  Called on entry and
+ * whenever the handler masks interrupts again.
+ */
+HOT void defer_irq_enter(void)
+{
+	irq_off_start = clock_ns();
+}
+
+/**
+ * @brief Ends a masked stretch of the interrupt path, before interrupts are
+ * enabled again.
+ */
+HOT void defer_irq_leave(void)
+{
+	irq_off_end();
+}
+
+/**
+ * @brief Runs all posted work.
+ *
+ * Called at the end of the interrupt handler with interrupts masked, and
+ * returns with them masked.  A nested call returns at once; the outer call
+ * sees its work.
+ */
+HOT void defer_run(void)
+{
+	unsigned int i;
+	int busy;
+
+	if(defer_active) {
+		irq_off_end();
+		return;
+	}
+	defer_active = 1;
+
+	do {
+		irq_off_end();
+		enable_interrupts();
+		do {
+			busy = 0;
+			for(i = 0; i < DEFER_MAX; i++) {
+				if(defer_pending[i] && defer_take(&defer_pending[i])) {
+					busy = 1;
+					if(defer_fn[i] != NULL)
+						defer_fn[i]();
+				}
+			}
+		} while(busy);
+		disable_interrupts();
+		irq_off_start = clock_ns();
+
+		/* anything posted after its byte was scanned is still pending */
+		busy = 0;
+		for(i = 0; i < DEFER_MAX; i++)
+			busy |= defer_pending[i];
+	} while(busy);
+
+	defer_active = 0;
+	irq_off_end();
+}
@@ -12,9 +12,12 @@
 #include <task.h>
 #include <sched.h>
 #include <device.h>
+#include <syscall.h>
+#include <crit.h>
 #include <arm/reg.h>
 #include <arm/psr.h>
 #include <arm/exception.h>
+#include <section.h>
 
 /**
  * @brief Fake device maintainence structure.
@@ -26,7 +29,8 @@
  * on every timer interrupt. In dev_update check if it is 
  * time to create a tasks new job. If so, make the task runnable.
  * There is a wait queue for every device which contains the tcbs of
- * all tasks waiting on the device event to occur.
+ * all tasks waiting on the device event to occur.  Tasks queue themselves in
+ * a critical section; dev_update runs in the tick's deferred work.
  */
 
 struct dev
@@ -36,9 +40,24 @@ struct dev
 };
 typedef struct dev dev_t;
 
+/**
+ * @brief A task waiting on a set of devices.
+ * It lives on the waiting task's kernel stack and sits on one list however
+ * many devices it names, so waking it dequeues it from all of them at once.
+ */
+struct dev_waiter
+{
+	tcb_t*             tcb;
+	unsigned long      mask;    /**< Devices waited on */
+	unsigned long      fired;   /**< Devices in mask that have signalled */
+	int                all;     /**< Wait for every device in mask, not any */
+	struct dev_waiter* next;
+};
+
 /* devices will be periodically signaled at the following frequencies */
 const unsigned long dev_freq[NUM_DEVICES] = {100, 200, 500, 50};
 static dev_t devices[NUM_DEVICES];
+static struct dev_waiter* mask_waiters;
 
 /**
  * @brief Initialize the sleep queues and match values for all devices.
@@ -50,6 +69,7 @@ void dev_init(void)
 		devices[i].next_match = dev_freq[i];
 		devices[i].sleep_queue = NULL;
 	}
+	mask_waiters = NULL;
 }
 
 
@@ -59,22 +79,86 @@ void dev_init(void)
  *
  * @param dev  Device number.
  */
-void dev_wait(unsigned int dev)
+HOT void dev_wait(unsigned int dev)
 {
 //	printf("dev wait called for dev %u by task %u\n", dev, get_cur_tcb()->cur_prio);
 	tcb_t *cur_tcb = get_cur_tcb();
 
+	ring_block();
+	crit_enter();
 	/*
 	 * Add the current task to the head of the sleep queue of device dev
 	 */
-	cur_tcb->sleep_queue = devices[dev].sleep_queue;
-	devices[dev].sleep_queue = cur_tcb;
+	sleepq_push(&devices[dev].sleep_queue, cur_tcb);
     /*
 	 * put this task to sleep and run the next highest priority task
 	 */
 	dispatch_sleep();
+	crit_exit();
+}
+
+/**
+ * @brief Like dev_wait, but gives up at the deadline tick.
+ *
+ * @return 0 if the device signalled, -ETIMEDOUT otherwise.
+ */
+int dev_wait_timeout(unsigned int dev, unsigned long deadline)
+{
+	int ret;
+
+	ring_block();
+	crit_enter();
+	sleepq_push(&devices[dev].sleep_queue, get_cur_tcb());
+	ret = dispatch_sleep_timeout(deadline);
+	crit_exit();
+	return ret;
+}
+
+
+/**
+ * @brief Puts a task to sleep until any or all of a set of devices signal.
+ *
+ * @param mask  Bit per device number, non-empty.
+ * @param all   Non-zero to wait for every device in mask.
+ *
+ * @return The devices in mask that signalled.
+ */
+unsigned long dev_wait_mask(unsigned long mask, int all)
+{
+	struct dev_waiter w;
+
+	w.tcb = get_cur_tcb();
+	w.mask = mask;
+	w.fired = 0;
+	w.all = all;
+
+	ring_block();
+	crit_enter();
+	w.next = mask_waiters;
+	mask_waiters = &w;
+	dispatch_sleep();
+	crit_exit();
+	return w.fired;
 }
 
+/*
+ * credit the devices in fired to every mask waiter and wake the satisfied
+ */
+static void dev_wake_mask(unsigned long fired)
+{
+	struct dev_waiter **link = &mask_waiters, *w;
+
+	while(*link != NULL) {
+		w = *link;
+		w->fired |= w->mask & fired;
+		if(w->all ? (w->fired == w->mask) : (w->fired != 0)) {
+			*link = w->next;
+			runqueue_add(w->tcb, w->tcb->cur_prio);
+		} else {
+			link = &w->next;
+		}
+	}
+}
 
 /**
  * @brief Signals the occurrence of an event on all applicable devices. 
@@ -83,10 +167,11 @@ void dev_wait(unsigned int dev)
  * interrupt corresponded to the interrupt frequency of a device, this 
  * function should ensure that the task is made ready to run 
  */
-void dev_update(unsigned long millis)
+HOT void dev_update(unsigned long millis)
 {
 	int i;
 	tcb_t *temp_tcb;
+	unsigned long fired = 0;
 //	printf("dev update called with millis %lu\n dev[0].next_match is %lu", millis, devices[0].next_match);
 	/*
 	 * for each device, check if its next match value matches the current
@@ -97,13 +182,11 @@ void dev_update(unsigned long millis)
 	for(i = 0; i < NUM_DEVICES; i++) {
 	 	if(devices[i].next_match == millis) {
 //			printf("\n next_match match for device %d\n", i);
-			while(devices[i].sleep_queue != NULL) {
-				temp_tcb = devices[i].sleep_queue;
+			while((temp_tcb = sleepq_pop(&devices[i].sleep_queue)) != NULL) {
 //				printf("\n adding task %u to run_queue\n", temp_tcb->cur_prio);
 				runqueue_add(temp_tcb, temp_tcb->cur_prio);
-				devices[i].sleep_queue = temp_tcb->sleep_queue;
-				temp_tcb->sleep_queue = NULL;
 			}
+			fired |= 1u << i;
 
 			/*
 			 * check for integer overflow with next_match
@@ -115,5 +198,28 @@ void dev_update(unsigned long millis)
 			devices[i].next_match += dev_freq[i];
 		}
 	}
+
+	/*
+	 * the tasks waiting on sets of devices see every device that
+	 * signalled in this tick at once
+	 */
+	if(fired != 0) {
+		dev_wake_mask(fired);
+		poll_dev_event(fired);
+	}
 }
 
+/**
+ * @brief The millis value at which the next device signals.
+ */
+unsigned long dev_next_match(void)
+{
+	unsigned long next = devices[0].next_match;
+	int i;
+
+	for(i = 1; i < NUM_DEVICES; i++) {
+		if((long)(devices[i].next_match - next) < 0)
+			next = devices[i].next_match;
+	}
+	return next;
+}
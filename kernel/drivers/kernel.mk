@@ -1,4 +1,4 @@
-DRIVER_OBJS := timer.o 
+DRIVER_OBJS := timer.o timer_fiq.o uart.o
 DRIVER_OBJS := $(DRIVER_OBJS:%=$(KDIR)/drivers/%)
 
 KOBJS += $(DRIVER_OBJS)
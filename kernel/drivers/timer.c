@@ -13,6 +13,12 @@
 #include <config.h>
 #include <sched.h>
 #include <device.h>
+#include <syscall.h>
+#include <ktimer.h>
+#include <defer.h>
+#include <arm/interrupt.h>
+#include <bits/time_page.h>
+#include <section.h>
 
 #define TIMER_FREQ_FACTOR 100
 
@@ -21,6 +27,18 @@
  */
 volatile unsigned long num_ticks;
 unsigned long overflow_count = 0;
+static unsigned long bh_ticks;   /* last tick the bottom half handled */
+
+/* first tick the bottom half has work for; the FIQ tick escalates there */
+volatile unsigned long tick_due;
+
+static void timer_bottom_half(void);
+#if OS_TICK_FIQ
+static void timer_escalate(unsigned int int_num);
+#endif
+
+/* published to tasks -- see bits/time_page.h */
+static struct time_page* const time_page = (struct time_page*)TIME_PAGE_ADDR;
 
 void init_timer(void)
 {
@@ -44,6 +62,41 @@ void init_timer(void)
 	 */
 	reg_write(OSTMR_OSMR_ADDR(0), oscr_10ms);
 	
+	/*
+	 * publish the time page; ticks and OSCR together give sub-tick time
+	 */
+	time_page->seq = 0;
+	time_page->ticks = num_ticks;
+	time_page->ticks_hi = 0;
+	time_page->sec = num_ticks / OS_TICKS_PER_SEC;
+	time_page->sec_ticks = num_ticks % OS_TICKS_PER_SEC;
+	time_page->ms_per_tick = OS_TIMER_RESOLUTION;
+	time_page->us_per_tick = 1000000 / OS_TICKS_PER_SEC;
+	time_page->ns_per_tick = 1000000000 / OS_TICKS_PER_SEC;
+	time_page->oscr_addr = PERIPHERAL_BASE + OSTMR_OSCR_ADDR;
+	time_page->oscr_hz = OSTMR_FREQ;
+	time_page->oscr_per_tick = oscr_10ms;
+	time_page->oscr_us_mult = (unsigned long)((1000000ULL << 32) / OSTMR_FREQ);
+	time_page->oscr_ns_mult = (unsigned long)((1000000000ULL << 16) / OSTMR_FREQ);
+
+	bh_ticks = num_ticks;
+	tick_due = num_ticks + 1;
+	defer_register(DEFER_TICK, timer_bottom_half);
+#if OS_TICK_FIQ
+	/*
+	 * the tick is an FIQ; OSMR1 matches right after every tick, and
+	 * enabling its IRQ is how the FIQ asks for the bottom half
+	 */
+	reg_write(OSTMR_OSMR_ADDR(1), 1);
+	int_set_prio(INT_OSTMR_1, INT_PRIO_HIGH);
+	install_int_handler(INT_OSTMR_1, timer_escalate);
+	timer_fiq_init();
+	install_fiq_source(INT_OSTMR_0);
+#else
+	int_set_prio(INT_OSTMR_0, INT_PRIO_HIGH);
+	install_int_handler(INT_OSTMR_0, timer_handler);
+#endif
+
 	/*
 	 * activate the osmr0 bit in oier
 	 */
@@ -57,15 +110,24 @@ void init_timer(void)
 	return;
 }
 
-void timer_handler(unsigned int int_num)
+HOT void timer_handler(unsigned int int_num)
 {		        
 	uint32_t ossr_reg;
 
 	/*
-	 * increment the numticks
+	 * increment the numticks -- readers of the time page retry while seq
+	 * is odd, so the tick and the OSCR reset look atomic to them
 	 */
 //	printf("inside timer handler\n");
+	time_page->seq++;
 	num_ticks++;
+	time_page->ticks = num_ticks;
+	if(num_ticks == 0)
+		time_page->ticks_hi++;
+	if(++time_page->sec_ticks == OS_TICKS_PER_SEC) {
+		time_page->sec_ticks = 0;
+		time_page->sec++;
+	}
 	if(num_ticks == 0) {
 		// there is an overflow
 		overflow_count++;
@@ -77,6 +139,7 @@ void timer_handler(unsigned int int_num)
 //	do {
 		reg_write(OSTMR_OSCR_ADDR, 0x0);
 //	} while(reg_read(OSTMR_OSCR_ADDR) != 0);
+	time_page->seq++;
 
 	/*
 	 * acknowlegde the interrupt
@@ -86,22 +149,89 @@ void timer_handler(unsigned int int_num)
 	reg_write(OSTMR_OSSR_ADDR, ossr_reg);
 
 	/*
-	 * update the devices
+	 * everything else runs with interrupts enabled
+	 */
+	defer_post(DEFER_TICK);
+
+	int_num = int_num;
+	return;
+}
+
+#if OS_TICK_FIQ
+/*
+ * the IRQ the FIQ tick raises when it reaches tick_due -- OIER is written
+ * whole, so a racing FIQ at worst raises it once more
+ */
+static void timer_escalate(unsigned int int_num)
+{
+	reg_write(OSTMR_OIER_ADDR, OSTMR_OIER_E0);
+	reg_write(OSTMR_OSSR_ADDR, OSTMR_OSSR_M1);
+	defer_post(DEFER_TICK);
+
+	int_num = int_num;
+}
+
+/*
+ * the first tick after bh_ticks at which a device signals, a kernel timer
+ * fires or, while a poller waits for input, the next tick
+ */
+static unsigned long timer_next_due(void)
+{
+	unsigned long due, expires;
+
+	due = (dev_next_match() + OS_TIMER_RESOLUTION - 1) / OS_TIMER_RESOLUTION;
+	if(ktimer_next(&expires) && KTIMER_DUE(due, expires))
+		due = expires;
+	if(poll_wants_input())
+		due = bh_ticks + 1;
+	return due;
+}
+#endif
+
+/**
+ * @brief Makes the FIQ tick escalate no later than tick.  Called when work
+ * is queued for the bottom half.
+ */
+void timer_due_by(unsigned long tick)
+{
+	if(!KTIMER_DUE(tick, tick_due))
+		tick_due = tick;
+}
+
+/*
+ * the deferred half of the tick
+ */
+HOT static void timer_bottom_half(void)
+{
+	/*
+	 * catch up tick by tick -- devices match on exact millis values
 	 */
-	dev_update(get_millis());
+	while(bh_ticks != num_ticks) {
+		bh_ticks++;
+
+		/*
+		 * update the devices
+		 */
+		dev_update(bh_ticks * OS_TIMER_RESOLUTION);
+
+		/*
+		 * fire the timeouts that are due -- a task that got its event
+		 * this tick keeps it
+		 */
+		ktimer_tick(bh_ticks);
+	}
 
 	/*
-	 * perform context switch
+	 * wake pollers whose console input arrived
 	 */
-//	if(!(num_ticks % 50)) {
-	dispatch_save();
-//	}
+	poll_tick();
 
-	int_num = int_num;
-	return;
+#if OS_TICK_FIQ
+	tick_due = timer_next_due();
+#endif
 }
 
-unsigned long get_ticks(void)
+HOT unsigned long get_ticks(void)
 {
 	return num_ticks;
 }
@@ -111,6 +241,54 @@ unsigned long get_millis(void)
 	return (get_ticks() * OS_TIMER_RESOLUTION); 
 }
 
+/*
+ * read the 64-bit tick count and the OSCR at the same instant, with the
+ * count clamped below one tick so the clock never steps backwards
+ */
+static uint64_t clock_snapshot(uint32_t *count)
+{
+	unsigned long seq, lo, hi;
+
+	do {
+		seq = time_page->seq;
+		lo = time_page->ticks;
+		hi = time_page->ticks_hi;
+		*count = reg_read(OSTMR_OSCR_ADDR);
+	} while((seq & 1) || seq != time_page->seq);
+
+	if(*count >= time_page->oscr_per_tick)
+		*count = time_page->oscr_per_tick - 1;
+	return ((uint64_t)hi << 32) | lo;
+}
+
+/*
+ * monotonic nanoseconds since init_timer, to the OSCR's 271 ns resolution
+ * @param: void
+ * @return uint64_t - nanoseconds
+ */
+HOT uint64_t clock_ns(void)
+{
+	uint32_t count;
+	uint64_t ticks = clock_snapshot(&count);
+
+	return ticks * time_page->ns_per_tick 
+	       + (((uint64_t)count * time_page->oscr_ns_mult) >> 16);
+}
+
+/*
+ * monotonic microseconds since init_timer
+ * @param: void
+ * @return uint64_t - microseconds
+ */
+uint64_t clock_us(void)
+{
+	uint32_t count;
+	uint64_t ticks = clock_snapshot(&count);
+
+	return ticks * time_page->us_per_tick 
+	       + (((uint64_t)count * time_page->oscr_us_mult) >> 32);
+}
+
 //TODO
 
 void destroy_timer(void)
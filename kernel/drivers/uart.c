@@ -0,0 +1,60 @@
+/** @file uart.c
+ *
+ * @brief The kernel console, driven straight from the FFUART.
+ *
+ * U-Boot has already set up the line (speed, framing, FIFOs); this only
+ * moves characters, the same way U-Boot's own serial driver does, so the
+ * kernel need not call through U-Boot's export table to reach it.
+ */
+
+#include <types.h>
+#include <exports.h>
+#include <arm/reg.h>
+#include <arm/uart.h>
+
+/*
+ * write a character to the console, as "\r\n" for '\n'
+ */
+void putc(const char c)
+{
+	if(c == '\n')
+		putc('\r');
+
+	while(!(reg_read(FFUART_LSR_ADDR) & FFUART_LSR_TDRQ));
+	reg_write(FFUART_THR_ADDR, (uint32_t)(unsigned char)c);
+}
+
+/*
+ * test whether putc can write a character -- even a '\n', which takes two
+ * slots -- without waiting: TDRQ means the FIFO is at least half empty
+ */
+int uart_tx_ready(void)
+{
+	return (reg_read(FFUART_LSR_ADDR) & FFUART_LSR_TDRQ) != 0;
+}
+
+/*
+ * write a string to the console
+ */
+void puts(const char* s)
+{
+	while(*s != '\0')
+		putc(*s++);
+}
+
+/*
+ * wait for and read a character from the console
+ */
+int getc(void)
+{
+	while(!(reg_read(FFUART_LSR_ADDR) & FFUART_LSR_DR));
+	return reg_read(FFUART_RBR_ADDR) & 0xff;
+}
+
+/*
+ * test whether a character is waiting on the console
+ */
+int tstc(void)
+{
+	return (reg_read(FFUART_LSR_ADDR) & FFUART_LSR_DR) != 0;
+}
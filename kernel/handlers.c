@@ -12,12 +12,27 @@
 #include <arm/timer.h>
 #include <arm/reg.h>
 #include <syscall.h>
+#include <lock.h>
 #include <arm/psr.h>
 #include <arm/exception.h>
+#include <arm/mmu.h>
+#include <swi_table.h>
+#include <section.h>
+
+/*
+ * U-Boot's default handlers as they were before we patched them, by vector,
+ * so they can be put back when the kernel exits
+ */
+static struct {
+	unsigned int *loc;
+	unsigned int inst[2];
+} saved_handlers[NUM_EXCEPTIONS];
 
  /*
- * function that installs the custom handler by hijacking the first 2 
- * instructions of the default handler
+ * function that installs the custom handler by hijacking the default
+ * handler: its 1st instruction becomes a branch straight to ours, or, if
+ * ours is out of branch range, its first 2 become ldr pc, [pc, #-4] and
+ * our address
  * @param: void
  * @return: 0 on success, < 0 on failure
  */
@@ -26,12 +41,15 @@ int install_handler(unsigned int *vector_addr, void *handler_addr)
 	unsigned int vector_inst;
 	unsigned int offset;
 	unsigned int *def_handler_loc;
+	long branch;
+	unsigned int ex;
 
 	/*
 	 * validate the vector address
 	 */
 	if((vector_addr != (unsigned int *)SWI_VECTOR_ADDR) 
-	     && (vector_addr != (unsigned int *)IRQ_VECTOR_ADDR)) {
+	     && (vector_addr != (unsigned int *)IRQ_VECTOR_ADDR)
+	     && (vector_addr != (unsigned int *)FIQ_VECTOR_ADDR)) {
 		printf("Invalid vector address passed to install_handler\n");
 		return -1;
 	}
@@ -52,10 +70,32 @@ int install_handler(unsigned int *vector_addr, void *handler_addr)
 	def_handler_loc = (unsigned int *)(*(unsigned int *)((char *)vector_addr + 
 												 ACTUAL_PC_OFFSET + offset));
 	/*
-	 * overwrite the 1st 2 instructions of the default handler
+	 * remember what was there, unless an earlier install already did
+	 */
+	ex = (unsigned int)vector_addr / sizeof(unsigned int);
+	if(saved_handlers[ex].loc == NULL) {
+		saved_handlers[ex].loc = def_handler_loc;
+		saved_handlers[ex].inst[0] = def_handler_loc[0];
+		saved_handlers[ex].inst[1] = def_handler_loc[1];
+	}
+
+	/*
+	 * overwrite the 1st instruction of the default handler with a branch,
+	 * which saves the load of the ldr pc form on every exception
 	 */
-	*def_handler_loc = (unsigned int)CUSTOM_HANDLER_INST1;
-	*(def_handler_loc + 1) = (unsigned int)handler_addr;
+	branch = (long)handler_addr - ((long)def_handler_loc + ACTUAL_PC_OFFSET);
+	if(branch >= -B_INST_RANGE && branch < B_INST_RANGE) {
+		*def_handler_loc = B_INST
+		                   | (((unsigned long)branch >> 2) & B_INST_OFFSET);
+	} else {
+		*def_handler_loc = (unsigned int)CUSTOM_HANDLER_INST1;
+		*(def_handler_loc + 1) = (unsigned int)handler_addr;
+	}
+
+	/*
+	 * the old instructions may be cached, the new ones not yet in memory
+	 */
+	icache_sync_range(def_handler_loc, 2 * sizeof(unsigned int));
 
 	/*
 	 * all set!
@@ -64,132 +104,85 @@ int install_handler(unsigned int *vector_addr, void *handler_addr)
 }
 
 /*
- * implementation of the C_SWI_Handler
- * @param: swi_num- swi number
- * @param: sp- stack pointer that points to block of user registers
- * @return: return value form swi on success, -1 on failure (swi num not 
-            supported)
+ * function that puts back every default handler install_handler patched,
+ * for returning to U-Boot
+ * @param: void
+ * @return: void
  */
-void C_SWI_Handler(int swi_num, unsigned int *sp)
+void restore_handlers(void)
 {
-	unsigned int r0, r1, r2;
-	switch(swi_num) {
-		case READ_SWI:
-			enable_interrupts();
-			r0 = *sp;
-			r1 = *(sp + 1);
-			r2 = *(sp + 2);
-			*sp = read_syscall((int)r0, (void *)r1, (size_t)r2);
-			break;
-		case WRITE_SWI:
-			enable_interrupts();
-			r0 = *sp;
-			r1 = *(sp + 1);
-			r2 = *(sp + 2);
-			*sp = write_syscall((int)r0, (const void *)r1, (size_t)r2);
-			break;
-		case TIME_SWI:
-			enable_interrupts();
-			*sp = time_syscall();
-			break;
-		case SLEEP_SWI:
-//			enable_interrupts();
-			r0 = *sp;
-		    sleep_syscall((unsigned long)r0);
-			break;
-		case CREATE_SWI:
-			r0 = *sp;
-			r1 = *(sp + 1);
-			*sp = task_create((task_t *)r0, (size_t)r1);
-		break;
-		case EVENT_WAIT:
-			printf("calling event_wait sp is %p\n", sp);
-			r0 = *sp;
-			*sp = event_wait((unsigned int)r0);
-//			while(1);	
-			printf("returned from event_wait\n");
-		break;
-		case MUTEX_CREATE:
-			*sp = mutex_create();
-		break;	
-		case MUTEX_LOCK:
-			r0 = *sp;
-			*sp = mutex_lock((int)r0);
-		break;	
-		case MUTEX_UNLOCK:
-			r0 = *sp;
-			*sp = mutex_unlock((int)r0);
-		break;	
-		default:
-		    printf("\n C_SWI_Handler:invalid SWI call, panic\n");
-			invalid_syscall(swi_num);	
+	unsigned int ex;
+
+	for(ex = 0; ex < NUM_EXCEPTIONS; ex++) {
+		if(saved_handlers[ex].loc == NULL)
+			continue;
+		saved_handlers[ex].loc[0] = saved_handlers[ex].inst[0];
+		saved_handlers[ex].loc[1] = saved_handlers[ex].inst[1];
+		icache_sync_range(saved_handlers[ex].loc, 
+		                  sizeof(saved_handlers[ex].inst));
+		saved_handlers[ex].loc = NULL;
 	}
-	return;
 }
 
 /*
- * implementation of the C_IRQ_Handler
- * @param: void
- * @return: void 
+ * handlers take their arguments straight from r0-r3, whatever their C types;
+ * the cast goes through void (*)(void), the generic function pointer type
  */
-void irq_handler(void) 
-{
-	uint32_t icpr_reg, osmr0_mask, ossr_reg;
-//	printf("inside irq handler\n");
-	/*
-	 * identify the source of IRQ
-	 */
-	icpr_reg = reg_read(INT_ICIP_ADDR);
+#define SWI_FN(f)  ((swi_fn_t)(void (*)(void))(f))
 
-	/*
-	 * if the source is not osmr0 == oscr, bail out
-	 */
-	osmr0_mask = 0x1 << INT_OSTMR_0;
-	if(!(icpr_reg & osmr0_mask)) {
-		printf("\n C_IRQ_Handler, IRQ from unsupported source, bailing out\n");
-		return;
-	}
+/* the full handler for call n */
+#define SWI(n, f)            [(n) - SWI_BASE] = { NULL, SWI_FN(f) }
+/* the same, with a fast handler tried first */
+#define SWI_FASTPATH(n, ff, f) \
+	[(n) - SWI_BASE] = { SWI_FN(ff), SWI_FN(f) }
 
-	/*
-	 * redirect control to timer handler
-	 */
-	timer_handler(icpr_reg);
-
-	 /*
-	  * acknowlegde the timer IRQ
-//	do {
-//		printf("inside do while loop\n");
-		ossr_reg = reg_read(OSTMR_OSSR_ADDR);
-		ossr_reg |= OSTMR_OSSR_M0;
-		reg_write(OSTMR_OSSR_ADDR, ossr_reg);
-//		ossr_reg &= ~OSTMR_OSSR_M0;
-//	} while(reg_read(OSTMR_OSSR_ADDR) != ossr_reg);
-	  */
-	return;
-}
+/*
+ * the syscall table -- see swi_table.h
+ */
+const struct swi_entry swi_table[SWI_TABLE_SIZE] = {
+	SWI(READ_SWI,            read_syscall),
+	SWI(WRITE_SWI,           write_syscall),
+	SWI(READ_TIMEOUT_SWI,    read_timeout_syscall),
+	SWI(READV_SWI,           readv_syscall),
+	SWI(WRITEV_SWI,          writev_syscall),
+	SWI(FCNTL_SWI,           fcntl_syscall),
+	SWI(POLL_SWI,            poll_syscall),
+	SWI_FASTPATH(TIME_SWI,   time_syscall, time_syscall),
+	SWI(SLEEP_SWI,           sleep_syscall),
+	SWI(CREATE_SWI,          task_create),
+	SWI(EVENT_WAIT,          event_wait),
+	SWI(EVENT_WAIT_MASK,     event_wait_mask),
+	SWI(EVENT_WAIT_TIMEOUT,  event_wait_timeout),
+	SWI(MUTEX_CREATE,        mutex_create),
+	SWI_FASTPATH(MUTEX_LOCK, mutex_lock_fast, mutex_lock),
+	SWI(MUTEX_LOCK_TIMEOUT,  mutex_lock_timeout),
+	SWI_FASTPATH(MUTEX_UNLOCK, mutex_unlock_fast, mutex_unlock),
+	SWI(STACK_USAGE,         stack_usage),
+	SWI(RING_SETUP,          ring_setup),
+	SWI(RING_ENTER,          ring_enter),
+};
 
 /*
- * function to initialize the IRQ controller registers
- * @param void
- * @return void
+ * implementation of the C_SWI_Handler -- the full path, taken by every call
+ * that has no fast handler or whose fast handler gave up
+ * @param: swi_num- swi number
+ * @param: sp- stack pointer that points to block of user registers
+ * @return: void -- the syscall's return value replaces r0 in the block
  */
-void init_irq_regs(void)
+HOT void C_SWI_Handler(int swi_num, unsigned int *sp)
 {
-	uint32_t icmr_mask, iclr_reg, iclr_mask;
-	icmr_mask = (0x1 << INT_OSTMR_0);
-	
-	/*
-	 * write this mask into ICMR
-	 */
-	reg_write(INT_ICMR_ADDR, icmr_mask);
+	const struct swi_entry *swi;
+	unsigned int n = (unsigned int)swi_num - SWI_BASE;
 
-	/*
-	 * ensure that the OSSRMR0 interrupt is routed as an IRQ
-	 */
-	iclr_reg = reg_read(INT_ICLR_ADDR);
-	iclr_mask = ~(0x1 << INT_OSTMR_0);
-	iclr_reg &= iclr_mask;
-	reg_write(INT_ICLR_ADDR, iclr_reg);
-	
-	return;
+	if(n >= SWI_TABLE_SIZE || swi_table[n].fn == NULL) {
+		printf("\n C_SWI_Handler:invalid SWI call, panic\n");
+		invalid_syscall(swi_num);
+	}
+
+	swi = &swi_table[n];
+	enable_interrupts();
+	*sp = swi->fn(sp[0], sp[1], sp[2], sp[3]);
+
+	/* the return path reloads spsr, which another task's SWI would clobber */
+	disable_interrupts();
 }
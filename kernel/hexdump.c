@@ -21,6 +21,7 @@
 
 #include <ctype.h>
 #include <exports.h>
+#include <section.h>
 
 /*
  * Print a buffer hexdump style.  Example:
@@ -41,7 +42,7 @@
  * It might be useful to have an option for printing out little-endianly.
  * Adapted from Godmar's hook.c.
  */
-void hexdump(void *buf, size_t len)
+COLD void hexdump(void *buf, size_t len)
 {
 	size_t i, j;
 	char *b = (char *)buf;
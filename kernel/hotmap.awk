@@ -0,0 +1,47 @@
+# hotmap.awk: reports the hot text of the kernel from its link map
+#
+# usage: awk -f hotmap.awk kernel.map
+#
+# Prints the bounds and size of the hot functions kernel.lds packed between
+# __text_hot_start and __text_hot_end, the I-cache lines they span, and what
+# each object contributed.
+
+function hex(s,    i, n)
+{
+	n = 0
+	s = tolower(s)
+	sub(/^0x/, "", s)
+	for(i = 1; i <= length(s); i++)
+		n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}
+
+$2 == "__text_hot_start" { start = hex($1) }
+$2 == "__text_hot_end"   { end = hex($1) }
+
+# an input section line: name, address, size, object
+/^ [.*]/ {
+	hot = ($1 == ".text.hot" && NF == 4)
+	if(hot) {
+		obj = $4
+		sub(/.*\//, "", obj)
+		if(!(obj in size))
+			order[nobj++] = obj
+		size[obj] += hex($3)
+	}
+	next
+}
+
+# a symbol inside the last input section
+hot && NF == 2 && $1 ~ /^0x/ { syms[obj] = syms[obj] " " $2 }
+
+END {
+	if(end == 0) {
+		print "hotmap: no __text_hot_end in the map" > "/dev/stderr"
+		exit 1
+	}
+	printf(".text.hot: 0x%08x-0x%08x, %d bytes, %d I-cache lines\n",
+	       start, end, end - start, int((end - start + 31) / 32))
+	for(i = 0; i < nobj; i++)
+		printf("%8d  %-16s%s\n", size[order[i]], order[i], syms[order[i]])
+}
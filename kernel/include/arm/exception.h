@@ -23,6 +23,14 @@
 #ifndef ASSEMBLER
 
 #include <inline.h>
+#include <config.h>
+
+/* CPSR bits set to mask interrupts; the FIQ tick is never masked */
+#if OS_TICK_FIQ
+#define PSR_INT_MASK  PSR_IRQ
+#else
+#define PSR_INT_MASK  (PSR_IRQ | PSR_FIQ)
+#endif
 
 /* Register context. */
 struct ex_context
@@ -53,7 +61,7 @@ INLINE void enable_interrupts(void)
 {
 	uint32_t cpsr;
 	asm volatile ("mrs %0, cpsr" : "=r" (cpsr));
-	cpsr &= ~(PSR_IRQ | PSR_FIQ);
+	cpsr &= ~PSR_INT_MASK;
 	asm volatile ("msr cpsr_c, %0" : : "r" (cpsr) : "memory", "cc");
 }
 
@@ -61,7 +69,7 @@ INLINE void disable_interrupts(void)
 {
 	uint32_t cpsr;
 	asm volatile ("mrs %0, cpsr" : "=r" (cpsr));
-	cpsr |= PSR_IRQ | PSR_FIQ;
+	cpsr |= PSR_INT_MASK;
 	asm volatile ("msr cpsr_c, %0" : : "r" (cpsr) : "memory", "cc");
 }
 
@@ -53,6 +53,11 @@
 
 #define NUM_INTERRUPTS  32
 
+/* Software priorities; a handler is only preempted by higher ones */
+#define INT_PRIO_LOW     0
+#define INT_PRIO_HIGH    3
+#define INT_PRIO_LEVELS  4
+
 #ifndef ASSEMBLER
 
 void interrupt_panic(unsigned int int_num) __attribute__((noreturn));
@@ -60,8 +65,13 @@ void init_interrupt(void);
 void destroy_interrupt(void);
 void irq_handler(void);
 void request_reschedule(void);
+int in_interrupt(void);
 void install_int_handler(unsigned int int_num, void (*int_handler)(unsigned int))
 	__attribute__((nonnull));
+void int_mask(unsigned int int_num);
+void int_unmask(unsigned int int_num);
+void int_set_prio(unsigned int int_num, unsigned int prio);
+void install_fiq_source(unsigned int int_num);
 
 #endif /* ASSEMBLER */
 
@@ -0,0 +1,72 @@
+/**
+ * @file mmu.h
+ *
+ * @brief The XScale MMU, caches and write buffer.
+ *
+ * The kernel maps the whole address space flat with 1MB sections: SDRAM is
+ * cached write-back and buffered, everything else -- flash, the peripheral
+ * window at PERIPHERAL_BASE -- is uncached and unbuffered, so register
+ * accesses reach the device in program order.  Every section is read/write
+ * in all modes except the one holding the time page, which is split into
+ * 4KB pages so that the time page alone is read-only to user mode.  Tasks
+ * are otherwise still checked with valid_addr, not by the MMU.
+ *
+ * The D-cache is not coherent with anything but the CPU.  Before a device
+ * reads memory the CPU wrote, clean it; before the CPU reads memory a device
+ * wrote, invalidate it; after writing instructions, sync the I-cache.
+ */
+
+#ifndef _MMU_H_
+#define _MMU_H_
+
+#define CACHE_LINE_SIZE      32
+
+/* CP15 control register (c1) */
+#define CP15_CTRL_M          0x00000001  /* MMU */
+#define CP15_CTRL_A          0x00000002  /* Alignment fault checking */
+#define CP15_CTRL_C          0x00000004  /* D-cache */
+#define CP15_CTRL_W          0x00000008  /* Write buffer */
+#define CP15_CTRL_Z          0x00000800  /* Branch target buffer */
+#define CP15_CTRL_I          0x00001000  /* I-cache */
+
+/* First-level section descriptors */
+#define MMU_SECTION_SHIFT    20
+#define MMU_SECTIONS         4096
+#define MMU_SECT             0x00000002
+#define MMU_SECT_B           0x00000004  /* Bufferable */
+#define MMU_SECT_C           0x00000008  /* Cacheable */
+#define MMU_SECT_AP_RW       0x00000c00  /* Read/write in all modes */
+#define MMU_SECT_CACHED      (MMU_SECT | MMU_SECT_AP_RW | MMU_SECT_C | MMU_SECT_B)
+#define MMU_SECT_UNCACHED    (MMU_SECT | MMU_SECT_AP_RW)
+
+/* First-level coarse table descriptors and the 4KB small pages in them;
+ * each page has four 1KB subpages with an AP field apiece */
+#define MMU_COARSE           0x00000001
+#define MMU_COARSE_ENTRIES   256
+#define MMU_PAGE_SHIFT       12
+#define MMU_PAGE_SMALL       0x00000002
+#define MMU_PAGE_B           0x00000004  /* Bufferable */
+#define MMU_PAGE_C           0x00000008  /* Cacheable */
+#define MMU_PAGE_AP_RW       0x00000ff0  /* Read/write in all modes */
+#define MMU_PAGE_AP_USER_RO  0x00000aa0  /* Read/write, read-only to user mode */
+#define MMU_PAGE_CACHED      (MMU_PAGE_SMALL | MMU_PAGE_AP_RW | MMU_PAGE_C | MMU_PAGE_B)
+#define MMU_PAGE_USER_RO     (MMU_PAGE_SMALL | MMU_PAGE_AP_USER_RO | MMU_PAGE_C | MMU_PAGE_B)
+
+/* Every section is in domain 0, whose accesses are checked against AP */
+#define MMU_DACR_CLIENT      0x00000001
+
+#ifndef ASSEMBLER
+
+#include <types.h>
+
+int mmu_init(void);
+void mmu_disable(void);
+
+void dcache_clean_range(const void* start, size_t len);
+void dcache_inval_range(void* start, size_t len);
+void dcache_flush_range(void* start, size_t len);
+void icache_sync_range(const void* start, size_t len);
+
+#endif /* ASSEMBLER */
+
+#endif /* _MMU_H_ */
@@ -36,14 +36,21 @@
 
 #define OSTMR_FREQ            3686400      /* Oscillator frequency in hz */
 
+#ifndef ASSEMBLER
+
+#include <types.h>
 
 void init_timer(void);
 void destroy_timer(void);
 void timer_handler(unsigned int int_num);
+void timer_fiq(void);
+void timer_fiq_init(void);
+void timer_due_by(unsigned long tick);
 unsigned long get_ticks(void);
 unsigned long get_millis(void);
+uint64_t clock_ns(void);
+uint64_t clock_us(void);
 
-#ifndef ASSEMBLER
 #endif /* ASSEMBLER */
 
 #endif /* _TIMER_H_ */
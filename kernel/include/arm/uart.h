@@ -0,0 +1,25 @@
+/**
+ * @file uart.h
+ *
+ * @brief Definitions for the PXA255 full-function UART, the console.
+ *
+ * @note As in timer.h, the addresses are the manual's minus 0x40000000.
+ */
+
+#ifndef _UART_H_
+#define _UART_H_
+
+#define FFUART_RBR_ADDR       0x00100000   /* Receive Buffer Register */
+#define FFUART_THR_ADDR       0x00100000   /* Transmit Holding Register */
+#define FFUART_LSR_ADDR       0x00100014   /* Line Status Register */
+#define FFUART_LSR_DR         0x00000001   /* Data ready */
+#define FFUART_LSR_TDRQ       0x00000020   /* Transmit FIFO has room */
+#define FFUART_LSR_TEMT       0x00000040   /* Transmitter empty */
+
+#ifndef ASSEMBLER
+
+int uart_tx_ready(void);
+
+#endif /* ASSEMBLER */
+
+#endif /* _UART_H_ */
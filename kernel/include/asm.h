@@ -29,6 +29,8 @@
 #define SIZE(x,s)    .size    x, s
 
 #define FUNC(x)      .text ; ALIGN ; FUNCSYM(x) ; GLOBAL(x)
+/* A function on the syscall, interrupt or dispatch path -- see section.h */
+#define HOT_FUNC(x)  .section .text.hot, "ax" ; ALIGN ; FUNCSYM(x) ; GLOBAL(x)
 #define	DATA(x,s)    .data ; ALIGN ; DATASYM(x) ; SIZE(x,s) ; GLOBAL(x)
 
 #define BSS_WORD32(x)    .comm x, 4, 4
@@ -0,0 +1,16 @@
+/** @file fcntl.h
+ *
+ * @brief Defines the descriptor flags and fcntl commands
+ */
+
+#ifndef BITS_FCNTL_H
+#define BITS_FCNTL_H
+
+/* fcntl commands */
+#define F_GETFL     3
+#define F_SETFL     4
+
+/* Descriptor status flags */
+#define O_NONBLOCK  04000   /**< Fail with EAGAIN instead of waiting */
+
+#endif /* BITS_FCNTL_H */
@@ -13,4 +13,7 @@
 #define STDOUT_FILENO 1
 #define STDERR_FILENO 2
 
+/* Descriptors poll uses for the simulated devices */
+#define DEV_FILENO(dev) (3 + (dev))
+
 #endif /* BITS_FILENO_H */
@@ -10,16 +10,35 @@
 #ifndef _CONFIG_H_
 #define _CONFIG_H_
 
+#include <bits/time_page.h>
+
 #define OS_TICKS_PER_SEC        100    /* Set the number of ticks in one second */
 #define OS_TIMER_RESOLUTION     (1000/OS_TICKS_PER_SEC)  /* Timer resolution in ms */
 
+/* Set to 1 to take the tick as an FIQ that only escalates to the IRQ path
+ * when the tick wakes something.  FIQs then stay enabled in the kernel. */
+#define OS_TICK_FIQ             0
+
+/* Set to 1 to time every critical section and keep the longest, with the
+ * address it was entered from, in the time page */
+#define OS_CRIT_TRACE           0
+
+/* Set to 0 to run with the MMU, D-cache and write buffer off, as U-Boot
+ * leaves them */
+#define OS_MMU                  1
+
 #define LOAD_ADDR  0xa0000000
-#define USR_STACK  0xa3000000
+#define USR_STACK  TIME_PAGE_ADDR   /* the time page sits on top of it */
 
 #define USR_START_ADDR        0xa0000000
-#define USR_END_ADDR          0xa3000000
+#define USR_END_ADDR          TIME_PAGE_ADDR
 
+/* Kernel stacks are OS_KSTACK_SIZE unless a task asks for another size.  All
+ * of them come out of an OS_KSTACK_POOL byte pool, of which a task set gets
+ * one OS_KSTACK_SIZE stack per TCB the os_tasks boot limit allows */
 #define OS_KSTACK_SIZE        4096
+#define OS_KSTACK_MIN         512
+#define OS_KSTACK_POOL        (OS_MAX_TASKS * OS_KSTACK_SIZE)
 #define OS_USTACK_ALIGN       1024
 
 /* OS_MAX_TASKS must be atleast 8 and must be atmost 64 */
@@ -30,4 +49,7 @@
 /* OS_NUM_MUTEX must be at lease 32 */
 #define OS_NUM_MUTEX	32
 
+/* Boot-time region from which every kernel object cache is carved */
+#define OS_SLAB_SIZE          (16 * 1024)
+
 #endif /* _CONFIG_H_ */
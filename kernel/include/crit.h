@@ -0,0 +1,49 @@
+/** @file crit.h
+ *
+ * @brief Declares the kernel's critical sections.
+ *
+ * Syscalls run with interrupts enabled, so a task in the kernel can be
+ * interrupted and, once the interrupt is done, preempted by a task of higher
+ * priority.  The state tasks share -- the run queue, the sleep queues of the
+ * devices and mutexes, mutex ownership, the kernel timers and the pollers --
+ * is only touched between crit_enter and crit_exit, which mask interrupts.
+ *
+ * Sections nest.  The outermost crit_exit puts back the interrupt state of
+ * the outermost crit_enter and, if a task above the current one became ready
+ * meanwhile and the section was entered with interrupts on, dispatches to it
+ * right there.  The interrupt path is never preempted by a task, so its
+ * deferred work needs no sections against task code; a dispatch it asks for
+ * happens as the outermost interrupt returns.
+ *
+ * With OS_CRIT_TRACE set, the longest section and the address it was entered
+ * from are kept in the time page.
+ */
+
+#ifndef _CRIT_H_
+#define _CRIT_H_
+
+#include <types.h>
+#include <config.h>
+
+/* The section state of a task while it is switched out */
+struct crit_state
+{
+	unsigned int depth;
+	uint32_t     cpsr;
+#if OS_CRIT_TRACE
+	void*        site;
+#endif
+};
+
+void crit_init(void);
+void crit_enter(void);
+void crit_exit(void);
+void crit_preempt(void);
+void crit_irq_return(void);
+
+/* Used by the dispatcher around a context switch */
+void crit_suspend(struct crit_state* s);
+void crit_resume(const struct crit_state* s);
+void crit_reset(void);
+
+#endif /* _CRIT_H_ */
@@ -0,0 +1,37 @@
+/** @file defer.h
+ *
+ * @brief Declares deferred interrupt work ("bottom halves").
+ *
+ * A top half runs with interrupts masked, acknowledges its hardware and
+ * posts its source.  Before the interrupt returns, defer_run calls the
+ * handler of every posted source with interrupts enabled, ahead of any
+ * task; a task its handlers woke is dispatched afterwards.  Interrupts that
+ * arrive meanwhile only run their top half; their work is picked up by the
+ * defer_run already in progress.
+ */
+
+#ifndef _DEFER_H_
+#define _DEFER_H_
+
+#include <types.h>
+
+/* Deferred work sources, in the order defer_run serves them */
+#define DEFER_TICK   0
+#define DEFER_MAX    8
+
+/* One byte per source, written 1 by its top half only */
+extern volatile uint8_t defer_pending[DEFER_MAX];
+
+void defer_init(void);
+void defer_register(unsigned int src, void (*fn)(void));
+void defer_irq_enter(void);
+void defer_irq_leave(void);
+void defer_run(void);
+
+/**
+ * @brief Marks src as having work.  Called by top halves; a single store,
+ * so it needs no lock against anything.
+ */
+#define defer_post(src) (defer_pending[(src)] = 1)
+
+#endif /* _DEFER_H_ */
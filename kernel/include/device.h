@@ -15,11 +15,18 @@
 
 #define NUM_DEVICES  4
 
+/* event_wait_mask modes */
+#define EVENT_ANY    0   /* Wake when any device in the mask signals */
+#define EVENT_ALL    1   /* Wake once every device in the mask has */
+
 extern const unsigned long dev_freq[NUM_DEVICES];
 
 void dev_init(void);
 void dev_wait(unsigned int dev);
+int dev_wait_timeout(unsigned int dev, unsigned long deadline);
+unsigned long dev_wait_mask(unsigned long mask, int all);
 void dev_update(unsigned long num_millis);
+unsigned long dev_next_match(void);
 
 #endif /* _DEVICE_H_ */
 
@@ -15,16 +15,20 @@
 #define ACTUAL_PC_OFFSET 0x8
 #define SWI_VECTOR_ADDR 0x8
 #define IRQ_VECTOR_ADDR 0x18
+#define FIQ_VECTOR_ADDR 0x1c
 #define LDR_INST_OFFSET 0x00000FFF
 #define LDR_VALID_FORMAT 0xe59ff000
 #define CUSTOM_HANDLER_INST1 0xe51ff004
+#define B_INST 0xea000000
+#define B_INST_OFFSET 0x00FFFFFF
+#define B_INST_RANGE 0x02000000
 
 /*
  * prototypes
  */
 int install_handler(unsigned int *vector_addr, void *handler_addr);
+void restore_handlers(void);
 void s_handler(void);
-void init_irq_regs(void);
 void irq_wrapper(void);
 
 #endif /* HANDLERS_H */
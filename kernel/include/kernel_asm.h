@@ -11,7 +11,6 @@
 /*
  * stack offsets
  */
-#define R8_OFFSET 60
 #define SPSR_STACK_OFFSET 56
 #define WORD_OFFSET 4
 #define TWO_WORD_OFFSET 8
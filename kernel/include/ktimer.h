@@ -0,0 +1,37 @@
+/** @file ktimer.h
+ *
+ * @brief Declares one-shot kernel timers driven by the OS tick.
+ *
+ * A timer is owned by its caller -- usually it sits on the kernel stack of
+ * a task that is about to sleep -- and is linked into a list kept sorted by
+ * expiry.  The tick only ever looks at the head of the list, and cancelling
+ * is O(1), so an armed timeout costs nothing until it is due.  Tasks arm and
+ * cancel timers in a critical section.
+ */
+
+#ifndef _KTIMER_H_
+#define _KTIMER_H_
+
+#include <types.h>
+
+struct ktimer
+{
+	unsigned long   expires;          /**< Tick count to fire at */
+	void          (*fn)(void* arg);   /**< Runs in the tick's deferred work */
+	void*           arg;
+	struct ktimer*  next;
+	struct ktimer** pprev;            /**< Link pointing at us, NULL if idle */
+};
+
+void ktimer_init(void);
+void ktimer_add(struct ktimer* t, unsigned long expires,
+                void (*fn)(void* arg), void* arg);
+void ktimer_cancel(struct ktimer* t);
+void ktimer_tick(unsigned long ticks);
+int ktimer_next(unsigned long* expires);
+unsigned long ktimer_deadline(unsigned long millis);
+
+/* True once ticks has reached the deadline; safe across wraparound */
+#define KTIMER_DUE(ticks, deadline) ((long)((ticks) - (deadline)) >= 0)
+
+#endif /* _KTIMER_H_ */
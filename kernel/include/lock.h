@@ -19,7 +19,6 @@
 
 struct mutex
 {
-	bool_e	bAvailable;		/* flag for availability */
 	tcb_t*	pHolding_Tcb;	/* who are using this mutex */
 	bool_e	bLock;			/* 1 for lock/0 for unlock */	
 	tcb_t*	pSleep_queue;	/* list of applications waiting for this mutex */
@@ -33,9 +32,13 @@ struct cond
 };
 typedef struct cond cond_t;
 
+int mutex_mem_init(unsigned int count);
 void mutex_init(void);	/* a function for initiating mutexes */
 int mutex_create(void);
 int mutex_lock(int mutex);
+int mutex_lock_fast(int mutex);
+int mutex_lock_timeout(int mutex, unsigned long millis);
 int mutex_unlock(int mutex);
+int mutex_unlock_fast(int mutex);
 
 #endif /* _LOCK_H_ */
@@ -12,22 +12,30 @@
 #include <task.h>
 #include <types.h>
 
-void sched_init(task_t* main_task);
+int sched_mem_init(unsigned int count);
+tcb_t* sched_init(task_t* main_task);
 
 /* Scheduler invocations */
 void dispatch_save(void);
 void dispatch_nosave(void) __attribute__((noreturn));
 void dispatch_sleep(void);
+int dispatch_sleep_timeout(unsigned long deadline);
 
 /* Entry assist */
 void launch_task(void); /* takes lambda and argument in r4, r5 */
 
 /* Task initialization */
-void allocate_tasks(task_t** tasks, size_t num_tasks);
+int sched_fits(const task_t* tasks, size_t num_tasks);
+int allocate_tasks(task_t** tasks, size_t num_tasks);
 int assign_schedule(task_t** tasks, size_t num_tasks);
 
+/* Stack usage reporting */
+size_t sched_stack_usage(stack_usage_t* usage, size_t count);
+void stack_dump(void);
+
 /* Current task state */
 uint8_t get_cur_prio(void);
+uint8_t get_cur_native_prio(void);
 tcb_t* get_cur_tcb(void);
 
 /* Run-queue/priority management */
@@ -35,4 +43,10 @@ void runqueue_add(tcb_t* tcb, uint8_t prio);
 tcb_t* runqueue_remove(uint8_t prio);
 uint8_t highest_prio(void);
 
+/* Sleep queue management */
+void sleepq_push(tcb_t* volatile* head, tcb_t* tcb);
+void sleepq_append(tcb_t* volatile* head, tcb_t* tcb);
+void sleepq_remove(tcb_t* tcb);
+tcb_t* sleepq_pop(tcb_t* volatile* head);
+
 #endif /* SCHED_H */
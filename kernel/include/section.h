@@ -0,0 +1,18 @@
+/** @file section.h
+ *
+ * @brief Places kernel functions by how often they run.
+ *
+ * kernel.lds packs the HOT functions together right after the entry point,
+ * so the syscall, interrupt and dispatch paths share as few I-cache lines as
+ * possible, and moves the COLD ones -- reports, validation, panics -- to the
+ * end of the text, out of their way.  Assembly uses HOT_FUNC from asm.h.
+ * `make kernel-hot' lists what ended up in the hot section.
+ */
+
+#ifndef _SECTION_H_
+#define _SECTION_H_
+
+#define HOT   __attribute__((section(".text.hot")))
+#define COLD  __attribute__((section(".text.unlikely")))
+
+#endif /* _SECTION_H_ */
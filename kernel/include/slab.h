@@ -0,0 +1,54 @@
+/** @file slab.h
+ *
+ * @brief Declares the kernel's fixed-size object caches.
+ *
+ * Each cache is carved once, at boot, out of a single region reserved for
+ * kernel objects and then hands out objects of one size.  Free objects are
+ * tracked in a two-level bitmap, so allocation is two count-leading-zero
+ * operations and freeing is a couple of bit sets -- neither depends on how
+ * many objects the cache holds.  How many TCBs or mutexes the system can
+ * have is the count passed to slab_create at boot rather than an array
+ * bound.
+ */
+
+#ifndef _SLAB_H_
+#define _SLAB_H_
+
+#include <types.h>
+
+/* Objects start on this boundary -- enough for any kernel type */
+#define SLAB_ALIGN       8
+
+/* Every cache starts on a cache line, so line-sized objects stay aligned */
+#define SLAB_LINE        32
+
+/* One summary bit per map word, 32 objects per map word */
+#define SLAB_MAP_WORDS   32
+#define SLAB_MAX_OBJS    (SLAB_MAP_WORDS * 32)
+
+struct slab_cache
+{
+	const char*        name;        /**< Reported by slab_dump */
+	char*              objs;        /**< First object */
+	size_t             obj_size;    /**< Object stride, SLAB_ALIGN multiple */
+	unsigned int       capacity;    /**< Number of objects */
+	uint32_t           summary;     /**< MSB-first: bit w set iff map[w] != 0 */
+	uint32_t           map[SLAB_MAP_WORDS]; /**< MSB-first: set bit = free */
+	unsigned int       in_use;      /**< Objects currently allocated */
+	unsigned int       high_water;  /**< Largest in_use since creation */
+	unsigned int       failures;    /**< Allocations refused for lack of room */
+	struct slab_cache* next;        /**< Next cache in creation order */
+};
+typedef struct slab_cache slab_cache_t;
+
+void slab_init(void);
+int slab_create(slab_cache_t* cache, const char* name, size_t size,
+                unsigned int count);
+void* slab_alloc(slab_cache_t* cache);
+void slab_free(slab_cache_t* cache, void* obj);
+void slab_reset(slab_cache_t* cache);
+unsigned int slab_index(const slab_cache_t* cache, const void* obj);
+void* slab_object(const slab_cache_t* cache, unsigned int index);
+void slab_dump(void);
+
+#endif /* _SLAB_H_ */
@@ -0,0 +1,39 @@
+/** @file swi_table.h
+ *
+ * @brief The table s_handler dispatches syscalls through.
+ *
+ * Each syscall number has an entry.  fn is called from the full entry path,
+ * which saves every user register, enables interrupts and may block or be
+ * preempted; see crit.h for what it must guard.  A call that
+ * is usually cheap can also have a fast handler, which s_handler calls
+ * first with only the AAPCS caller-saved registers stacked and interrupts
+ * still masked.  A fast handler must not block, reschedule, enable
+ * interrupts or print; when it cannot finish the call it returns SWI_SLOW,
+ * having changed nothing, and the call is restarted on the full path.
+ */
+
+#ifndef _SWI_TABLE_H_
+#define _SWI_TABLE_H_
+
+#define SWI_TABLE_SIZE  256          /* Covers SWI_BASE to SWI_BASE + 255 */
+#define SWI_ENTRY_SIZE  8
+
+#define SWI_SLOW        0x80000000   /* Fast handler: take the full path */
+
+#ifndef ASSEMBLER
+
+#include <types.h>
+
+typedef int (*swi_fn_t)(uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3);
+
+struct swi_entry
+{
+	swi_fn_t fast;    /**< Leaf handler, or NULL */
+	swi_fn_t fn;      /**< Full handler, or NULL for an invalid call */
+};
+
+extern const struct swi_entry swi_table[SWI_TABLE_SIZE];
+
+#endif /* ASSEMBLER */
+
+#endif /* _SWI_TABLE_H_ */
@@ -13,7 +13,22 @@
 #include <task.h>
 
 ssize_t read_syscall(int fd, void *buf, size_t count);
+ssize_t read_timeout_syscall(int fd, void *buf, size_t count,
+                             unsigned long millis);
 ssize_t write_syscall(int fd, const void *buf, size_t count);
+struct iovec;
+ssize_t readv_syscall(int fd, const struct iovec *iov, int iovcnt);
+ssize_t writev_syscall(int fd, const struct iovec *iov, int iovcnt);
+int fcntl_syscall(int fd, int cmd, unsigned long arg);
+void io_init(void);
+
+struct pollfd;
+void poll_init(void);
+int poll_syscall(struct pollfd* fds, unsigned long nfds, int timeout);
+void poll_dev_event(unsigned long fired);
+void poll_tick(void);
+int poll_wants_input(void);
+int poll_input(unsigned long deadline);
 
 unsigned long time_syscall(void);
 void sleep_syscall(unsigned long millis);
@@ -22,5 +37,14 @@ void invalid_syscall(unsigned int num) __attribute__((noreturn));
 
 int task_create(task_t* tasks, size_t num_tasks);
 int event_wait(unsigned int dev);
+int event_wait_mask(unsigned long mask, int mode);
+int event_wait_timeout(unsigned int dev, unsigned long millis);
+int stack_usage(stack_usage_t* usage, size_t count);
+
+struct ring;
+void ring_init(void);
+int ring_setup(struct ring* ring);
+int ring_enter(void);
+void ring_block(void);
 
 #endif /* SYSCALL_H */
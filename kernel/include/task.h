@@ -25,9 +25,24 @@ struct task
 	void*         stack_pos;   /**< The starting position of the task's sp */
 	unsigned long C;           /**< The worst-case computation time */
 	unsigned long T;           /**< The task's period */
+	unsigned long kstack_size; /**< Kernel stack bytes, 0 for OS_KSTACK_SIZE */
+	unsigned long ustack_size; /**< User stack bytes to track, 0 for none */
 };
 typedef struct task task_t;
 
+/**
+ * Peak stack usage of one task, as reported by the stack_usage syscall.
+ */
+struct stack_usage
+{
+	unsigned long prio;        /**< The task's native priority */
+	unsigned long kstack_size; /**< Kernel stack bytes */
+	unsigned long kstack_peak; /**< Most kernel stack bytes ever used */
+	unsigned long ustack_size; /**< Tracked user stack bytes, 0 if untracked */
+	unsigned long ustack_peak; /**< Most tracked user stack bytes ever used */
+};
+typedef struct stack_usage stack_usage_t;
+
 
 /**
  * Register context for the scheduler.
@@ -50,18 +65,30 @@ struct sched_context
 typedef volatile struct sched_context sched_context_t;
 
 
+/**
+ * Scheduler state of one task.
+ *
+ * TCBs come from a slab cache as one dense array of 64-byte, line-aligned
+ * objects, so walking or switching tasks never strides over a stack.  The
+ * fields a dispatch reads come first.  Kernel stacks are allocated
+ * separately, sized per task, and the cold user stack bounds that only the
+ * stack usage report reads live in the scheduler.
+ *
+ * A sleeping task is linked into at most one sleep queue through sleep_queue
+ * and sleep_pprev, so a timeout can take it off in O(1) whichever queue it
+ * is on.
+ */
 struct tcb
 {
-	uint8_t          native_prio;        /**< The native priority of the task without escalation */
 	uint8_t          cur_prio;           /**< The current priority of the task after priority inheritance */
-	sched_context_t  context;            /**< The task's serialized context -- if not running */
-	int              holds_lock;         /**< 1 if the task is currently owning a lock */
+	uint8_t          native_prio;        /**< The native priority of the task without escalation */
+	uint8_t          holds_lock;         /**< 1 if the task is currently owning a lock */
 	volatile struct tcb* sleep_queue;    /**< If this task is asleep, this is its sleep queue link */
-	/** Embed the kernel stack here -- AAPCS wants 8 byte alignment */
-	uint32_t         kstack[OS_KSTACK_SIZE/sizeof(uint32_t)] 
-	                     __attribute__((aligned(8)));
-	uint32_t         kstack_high[0];
-};
+	volatile struct tcb* volatile* sleep_pprev; /**< The link pointing at this task, NULL if not queued */
+	sched_context_t  context;            /**< The task's serialized context -- if not running */
+	uint32_t*        kstack;             /**< Lowest word of the kernel stack -- holds the canary */
+	uint32_t*        kstack_high;        /**< One past the top of the kernel stack -- 8 byte aligned for AAPCS */
+} __attribute__((aligned(32)));
 typedef volatile struct tcb tcb_t;
 
 
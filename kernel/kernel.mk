@@ -3,7 +3,8 @@ KSTART = $(KDIR)/start.o
 
 # All core kernel objects go here.  Add objects here if you need to.
 KOBJS := assert.o main.o math.o memcheck.o raise.o ctype.o hexdump.o \
-         device.o handlers.o kernel_asm.o
+         device.o handlers.o kernel_asm.o slab.o ktimer.o \
+         defer.o crit.o doprnt.o printf.o
 
 KOBJS := $(KOBJS:%=$(KDIR)/%)
 
@@ -14,14 +15,21 @@ KOBJS := $(KOBJS:%=$(KDIR)/%)
 -include $(KDIR)/drivers/kernel.mk
 
 ALL_OBJS += $(KOBJS) $(KSTART)
-ALL_CLOBBERS += $(KERNEL) $(KERNEL).bin
+ALL_CLOBBERS += $(KERNEL) $(KERNEL).bin $(KERNEL).map
 
 # Put everything needed by the kernel into the final binary.
 # KOBJS contains core kernel objects.
 # AOBJS contains objects that are ARM dependent.
 # UOBJS contains objects that are U-boot dependent.
 
-$(KERNEL): $(KSTART) $(KOBJS) $(UOBJS)
+# kernel.lds puts _start first, then the hot functions, and the cold ones last.
+$(KERNEL): $(KSTART) $(KOBJS) $(UOBJS) $(KDIR)/kernel.lds
 	@echo LD $(notdir $@)
-	@$(LD) -static $(LDFLAGS) -o $@ $^ $(LIBGCC)
+	@$(LD) -static $(LDFLAGS) -T $(KDIR)/kernel.lds -Map $@.map \
+		-o $@ $(filter %.o,$^) $(LIBGCC)
+
+# Report the size of the hot text from the link map.
+.PHONY: kernel-hot
+kernel-hot: $(KERNEL)
+	@awk -f $(KDIR)/hotmap.awk $(KERNEL).map
 
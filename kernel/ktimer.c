@@ -0,0 +1,108 @@
+/** @file ktimer.c
+ *
+ * @brief One-shot kernel timers, kept in a list sorted by expiry.
+ *
+ * Arming walks the list to find its slot, which is linear in the number of
+ * armed timers -- at most one per task.  Firing and cancelling are O(1).
+ * Timers fire from the tick's deferred work.  Syscalls run with interrupts
+ * enabled, so task code must arm and cancel inside a critical section; the
+ * deferred work is never preempted by a task and needs none.
+ */
+
+#include <types.h>
+#include <config.h>
+#include <ktimer.h>
+#include <arm/timer.h>
+#include <section.h>
+
+static struct ktimer* timers;
+
+/**
+ * @brief Forgets every armed timer -- called for a new task set.
+ */
+void ktimer_init(void)
+{
+	timers = NULL;
+}
+
+/**
+ * @brief Arms t to call fn(arg) from the first tick at or after expires.
+ */
+void ktimer_add(struct ktimer* t, unsigned long expires,
+                void (*fn)(void* arg), void* arg)
+{
+	struct ktimer** link = &timers;
+
+	t->expires = expires;
+	t->fn = fn;
+	t->arg = arg;
+
+	/* after every timer due no later, so equal deadlines fire in order */
+	while(*link != NULL && KTIMER_DUE(expires, (*link)->expires))
+		link = &(*link)->next;
+
+	t->next = *link;
+	t->pprev = link;
+	if(t->next != NULL)
+		t->next->pprev = &t->next;
+	*link = t;
+
+	if(link == &timers)
+		timer_due_by(expires);
+}
+
+/**
+ * @brief Disarms t.  Does nothing if it has already fired.
+ */
+void ktimer_cancel(struct ktimer* t)
+{
+	if(t->pprev == NULL)
+		return;
+
+	*t->pprev = t->next;
+	if(t->next != NULL)
+		t->next->pprev = t->pprev;
+	t->pprev = NULL;
+}
+
+/**
+ * @brief Fires every timer that is due.  Called on each timer tick.
+ */
+HOT void ktimer_tick(unsigned long ticks)
+{
+	struct ktimer* t;
+
+	while(timers != NULL && KTIMER_DUE(ticks, timers->expires)) {
+		t = timers;
+		ktimer_cancel(t);
+		t->fn(t->arg);
+	}
+}
+
+/**
+ * @brief Finds when the next timer fires.
+ *
+ * @return 1 with *expires set if a timer is armed, 0 otherwise.
+ */
+int ktimer_next(unsigned long* expires)
+{
+	if(timers == NULL)
+		return 0;
+	*expires = timers->expires;
+	return 1;
+}
+
+/**
+ * @brief The first tick by which at least millis milliseconds have passed.
+ *
+ * The current tick is already partly over, so the count rounded up to whole
+ * ticks gets one more.  millis 0 gives the current tick, which is already
+ * due, so a timeout of 0 never waits.
+ */
+unsigned long ktimer_deadline(unsigned long millis)
+{
+	if(millis == 0)
+		return get_ticks();
+	return get_ticks() + millis / OS_TIMER_RESOLUTION
+	       + (millis % OS_TIMER_RESOLUTION != 0) + 1;
+}
@@ -21,92 +21,80 @@
 #include <exports.h> // temp
 #endif
 #include <types.h>
+#include <slab.h>
+#include <ktimer.h>
+#include <arm/timer.h>
+#include <swi_table.h>
+#include <syscall.h>
+#include <crit.h>
+#include <section.h>
 
-mutex_t gtMutex[OS_NUM_MUTEX];
+static slab_cache_t mutex_cache;
+
+/**
+ * @brief Carves room for count mutexes out of the slab region.
+ *
+ * Called once at boot.
+ */
+int mutex_mem_init(unsigned int count)
+{
+	return slab_create(&mutex_cache, "mutex", sizeof(mutex_t), count);
+}
 
 void mutex_init()
 {
-	int i;
 	/*
-	 * init all the mutex to default values
+	 * release every mutex of the previous task set
 	 */
-	for(i = 0; i < OS_NUM_MUTEX; i++) {
-		gtMutex[i].bAvailable = TRUE;
-		gtMutex[i].pHolding_Tcb = NULL;
-		gtMutex[i].bLock = FALSE;
-		gtMutex[i].pSleep_queue = NULL;
-	}
+	slab_reset(&mutex_cache);
 }
 
 int mutex_create(void)
 {
-	int i;
+	mutex_t *mut;
 
 	/*
-	 * find the next available mutex
+	 * take the lowest numbered free mutex
 	 */
-	for(i = 0; i < OS_NUM_MUTEX; i++) {
-		if(gtMutex[i].bAvailable == TRUE) break;
-	}
-
-	if(i == OS_NUM_MUTEX) {
+	crit_enter();
+	mut = slab_alloc(&mutex_cache);
+	if(mut == NULL) {
+		crit_exit();
 		printf("no mutexes available\n");
 		return -ENOMEM;
 	}
 
-	/*
-	 * mark this mutex as not available
-	 */
-	gtMutex[i].bAvailable = FALSE;
-	return i;
+	mut->pHolding_Tcb = NULL;
+	mut->bLock = FALSE;
+	mut->pSleep_queue = NULL;
+	crit_exit();
+	return slab_index(&mutex_cache, mut);
 }
 
 void add_to_mutex_sleep_queue(mutex_t *mut, tcb_t *target_tcb)
 {
-	tcb_t *prev_tcb = NULL;
-	tcb_t *cur_tcb;
-
 //	printf("adding %d to sleep queue head is \n", target_tcb->native_prio, 
 //	                                              mut->pSleep_queue);
-	
-	if(mut->pSleep_queue == NULL) {
-		mut->pSleep_queue = target_tcb;	
-		target_tcb->sleep_queue = NULL;
-//		printf("inside add finction, after adding, inside if head is %p\n", 
-//		    mut->pSleep_queue);
-		return;
-	}
-
-	cur_tcb = mut->pSleep_queue;
-
-	while(cur_tcb != NULL) {
-		prev_tcb = cur_tcb;
-		cur_tcb = cur_tcb->sleep_queue;
-	}
-
-	prev_tcb->sleep_queue = target_tcb;
-	target_tcb->sleep_queue = NULL;
+	sleepq_append(&mut->pSleep_queue, target_tcb);
 }
 
-int mutex_lock(int mutex)
+/*
+ * locks the mutex, sleeping until the deadline tick if timed is set
+ */
+static int mutex_acquire(int mutex, int timed, unsigned long deadline)
 {
 	mutex_t *mut;
 	tcb_t *cur_tcb;
+	int ret;
 
 //	printf("lock called by %u\n", get_cur_tcb()->native_prio);
 
-	if((mutex < 0) || (mutex >= OS_NUM_MUTEX)) {
-		printf("invalid mutex number passed to mutex_lock\n");
-		return -EINVAL;
-	}
-
-	mut = &gtMutex[mutex];
-
 	/*
-	 * check if mutex create was called before mutex lock on this mutex
+	 * a negative handle wraps to an index past the end of the cache
 	 */
-	if(mut->bAvailable == TRUE) {
-//		printf("mutex lock called before mutex create on mutex %d\n", mutex);
+	mut = slab_object(&mutex_cache, (unsigned int)mutex);
+	if(mut == NULL) {
+		printf("invalid mutex number passed to mutex_lock\n");
 		return -EINVAL;
 	}
 
@@ -115,7 +103,14 @@ int mutex_lock(int mutex)
 	 */
 	cur_tcb = get_cur_tcb();
 //	printf("before checking holding tcb cut prio is %u\n", cur_tcb->native_prio);
+	/*
+	 * a held mutex is about to put us to sleep -- run queued syscalls first
+	 */
+	if(mut->bLock == TRUE)
+		ring_block();
+	crit_enter();
 	if(mut->pHolding_Tcb == cur_tcb) {
+		crit_exit();
 		printf("task %u is already holding mutex %d", cur_tcb->native_prio, 
 		                                              mutex);
 		return -EDEADLOCK;
@@ -127,20 +122,74 @@ int mutex_lock(int mutex)
 	 */
 	if(mut->bLock == TRUE) {
 		// this mutex is already locked
+		if(timed && KTIMER_DUE(get_ticks(), deadline)) {
+			crit_exit();
+			return -ETIMEDOUT;
+		}
 		add_to_mutex_sleep_queue(mut, cur_tcb);
 //		printf("after adding to sleep queue, mut->sleep_queue is %p\n", mut->pSleep_queue);
-		dispatch_sleep();
+		/*
+		 * mutex_unlock hands the mutex over before it wakes us, so it is
+		 * ours once we run again -- unless the timeout took us off the
+		 * queue first, and then it was never handed to us
+		 */
+		if(timed) {
+			ret = dispatch_sleep_timeout(deadline);
+			if(ret < 0) {
+				crit_exit();
+				return ret;
+			}
+		} else {
+			dispatch_sleep();
+		}
+		crit_exit();
+		return 0;
 	}
 
 	/*
-	 * this task is woken up. set this task as the current owner of the mutex
+	 * the mutex is free. set this task as the current owner of the mutex
 	 */
 	mut->bLock = TRUE;
 	mut->pHolding_Tcb = cur_tcb;
+	crit_exit();
 //	printf("\n in lock, updated holding tcb to %p\n", mut->pHolding_Tcb);
 	return 0;
 }
 
+int mutex_lock(int mutex)
+{
+	return mutex_acquire(mutex, 0, 0);
+}
+
+/**
+ * @brief The SWI fast path of mutex_lock: takes a free mutex.
+ *
+ * @return 0 once locked, or SWI_SLOW for anything else -- a held mutex or
+ *         an error -- which mutex_lock then handles.
+ */
+HOT int mutex_lock_fast(int mutex)
+{
+	mutex_t *mut = slab_object(&mutex_cache, (unsigned int)mutex);
+
+	if(mut == NULL || mut->bLock == TRUE)
+		return SWI_SLOW;
+
+	mut->bLock = TRUE;
+	mut->pHolding_Tcb = get_cur_tcb();
+	return 0;
+}
+
+/**
+ * @brief Like mutex_lock, but gives up after millis milliseconds.
+ *
+ * @return 0 once locked, -ETIMEDOUT if the mutex stayed locked, or the
+ *         errors of mutex_lock.  With millis 0 it only tries the lock.
+ */
+int mutex_lock_timeout(int mutex, unsigned long millis)
+{
+	return mutex_acquire(mutex, 1, ktimer_deadline(millis));
+}
+
 int mutex_unlock(int mutex)
 {
 	mutex_t *mut;
@@ -148,18 +197,12 @@ int mutex_unlock(int mutex)
 
 //	printf("unlock called by %u\n", get_cur_tcb()->native_prio);
 
-	if((mutex < 0) || (mutex >= OS_NUM_MUTEX)) {
-		printf("invalid mutex number passed to mutex_unlock\n");
-		return -EINVAL;
-	}
-
-	mut = &gtMutex[mutex];
-
 	/*
-	 * check if mutex create was called before mutex unlock on this mutex
+	 * a negative handle wraps to an index past the end of the cache
 	 */
-	if(mut->bAvailable == TRUE) {
-		printf("mutex unlock called before mutex create on mutex %d\n", mutex);
+	mut = slab_object(&mutex_cache, (unsigned int)mutex);
+	if(mut == NULL) {
+		printf("invalid mutex number passed to mutex_unlock\n");
 		return -EINVAL;
 	}
 
@@ -167,29 +210,57 @@ int mutex_unlock(int mutex)
 	 * check if the current task is already holding the mutex
 	 */
 	cur_tcb = get_cur_tcb();
+	crit_enter();
 	if(mut->pHolding_Tcb != cur_tcb) {
+		crit_exit();
 		printf("task %u is not the holder of mutex %d", cur_tcb->native_prio, 
 		                                              mutex);
 		return -EPERM;
 	}
 
 	/*
-	 * mark this mutex as unlocked
-	 */
-	mut->bLock = FALSE;
-	mut->pHolding_Tcb = NULL;
-	/*
-	 * wake up the first task waiting on this mutex's sleep queue
+	 * hand the mutex straight to the first task waiting on this mutex's
+	 * sleep queue and wake it -- it stays locked, so neither the fast path
+	 * nor a task that runs before the waiter can take it in between
 	 */
 //	printf("before checking mut->sleep_queue in unlock head is %p\n", 
 //	mut->pSleep_queue);
-	if(mut->pSleep_queue != NULL) {
-		next_tcb = mut->pSleep_queue;
-		mut->pSleep_queue = next_tcb->sleep_queue;
-		next_tcb->sleep_queue = NULL;
-//		mut->pHodling_Tcb = next_tcb;
+	next_tcb = sleepq_pop(&mut->pSleep_queue);
+	if(next_tcb != NULL) {
+		mut->pHolding_Tcb = next_tcb;
 //		printf("in unlock addin %u to run queue\n", next_tcb->cur_prio);
 		runqueue_add(next_tcb, next_tcb->cur_prio);
+	} else {
+		/*
+		 * nobody waits: mark this mutex as unlocked
+		 */
+		mut->bLock = FALSE;
+		mut->pHolding_Tcb = NULL;
 	}
+
+	/*
+	 * a waiter above us runs from here
+	 */
+	crit_exit();
+	return 0;
+}
+
+/**
+ * @brief The SWI fast path of mutex_unlock: releases a mutex nobody waits
+ * for.
+ *
+ * @return 0 once unlocked, or SWI_SLOW to let mutex_unlock wake a waiter or
+ *         report an error.
+ */
+HOT int mutex_unlock_fast(int mutex)
+{
+	mutex_t *mut = slab_object(&mutex_cache, (unsigned int)mutex);
+
+	if(mut == NULL || mut->pHolding_Tcb != get_cur_tcb()
+	   || mut->pSleep_queue != NULL)
+		return SWI_SLOW;
+
+	mut->bLock = FALSE;
+	mut->pHolding_Tcb = NULL;
 	return 0;
 }
@@ -15,15 +15,45 @@
 #include <assert.h>
 #include "handlers.h"
 #include <arm/timer.h>
+#include <arm/interrupt.h>
+#include <arm/mmu.h>
+#include <config.h>
+#include <lock.h>
+#include <slab.h>
+#include <defer.h>
+#include <crit.h>
+#include <exports.h>
 
 uint32_t global_data;
 
+/*
+ * read an object limit from the U-Boot environment, e.g. `setenv os_mutexes 64'
+ */
+static unsigned int boot_limit(const char* name, unsigned int def,
+                               unsigned int max)
+{
+	char *val = getenv((char*)name), *end;
+	unsigned long n;
+
+	if(val == NULL)
+		return def;
+	n = simple_strtoul(val, &end, 0);
+	return (*end != '\0' || n == 0 || n > max) ? def : n;
+}
+
 int kmain(int argc, char** argv, uint32_t table)
 {
 
 	app_startup();
 	global_data = table;
 	/* add your code up to assert statement */
+
+#if OS_MMU
+	/*
+	 * map memory and turn the caches on before anything else runs
+	 */
+	mmu_init();
+#endif
 	
 	/*
 	 * set up the custom swi ad irq handler by hijacking 
@@ -32,20 +62,44 @@ int kmain(int argc, char** argv, uint32_t table)
 	 */
 	if(install_handler((unsigned int *)SWI_VECTOR_ADDR, (void *)s_handler) < 0){
 		printf("\n KERNEL MAIN: installation of custom SWI handler failed");
-		return 0xbadc0de;
+		goto fail;
 }
 
 	if(install_handler((unsigned int *)IRQ_VECTOR_ADDR, (void *)irq_wrapper) < 0){
 		printf("\n KERNEL MAIN: installation of custom IRQ handler failed");
-		return 0xbadc0de;
+		goto fail;
+}
+#if OS_TICK_FIQ
+	if(install_handler((unsigned int *)FIQ_VECTOR_ADDR, (void *)timer_fiq) < 0){
+		printf("\n KERNEL MAIN: installation of FIQ tick handler failed");
+		goto fail;
 }
+#endif
 	printf("finished installing handlers\n");
 
 	/*
-	 * init the IRQ related registers
+	 * size the kernel object caches -- the run queue has one slot per
+	 * priority, so there can be no more TCBs than priorities
 	 */
-	init_irq_regs();	
+	slab_init();
+	if(sched_mem_init(boot_limit("os_tasks", OS_MAX_TASKS, OS_MAX_TASKS)) < 0
+	   || mutex_mem_init(boot_limit("os_mutexes", OS_NUM_MUTEX,
+	                                SLAB_MAX_OBJS)) < 0) {
+		printf("\n KERNEL MAIN: not enough memory for kernel objects");
+		goto fail;
+	}
+
+	/*
+	 * mask every interrupt source until its driver installs a handler
+	 */
+	init_interrupt();
 	
+	/*
+	 * clear the deferred work before any source can post or register
+	 */
+	defer_init();
+	crit_init();
+
 	/*
 	 * init the timer driver
 	 */
@@ -60,4 +114,12 @@ int kmain(int argc, char** argv, uint32_t table)
 	argv[0] = argv[0];
 
 	assert(0);        /* should never get here */
+
+	/*
+	 * hand U-Boot back its handlers and its view of memory
+	 */
+fail:
+	restore_handlers();
+	mmu_disable();
+	return 0xbadc0de;
 }
@@ -0,0 +1,28 @@
+/** @file printf.c
+ *
+ * @brief Formatted printing to the console, with the libc's _doprnt.
+ */
+
+#include <stdarg.h>
+#include <exports.h>
+#include <doprnt.h>
+
+static void printf_char(char* arg, int c)
+{
+	putc((char)c);
+	arg = arg;
+}
+
+void vprintf(const char* fmt, va_list args)
+{
+	_doprnt(fmt, args, 0, printf_char, NULL);
+}
+
+void printf(const char* fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+}
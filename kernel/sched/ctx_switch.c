@@ -17,12 +17,14 @@
 #include <arm/psr.h>
 #include <arm/exception.h>
 #include <kernel_asm.h>
+#include <syscall.h>
+#include <crit.h>
+#include <section.h>
 #ifdef DEBUG_MUTEX
 #include <exports.h>
 #endif
 
 static tcb_t* cur_tcb; /* use this if needed */
-unsigned int kstack_high_offset;
 unsigned int ctx_lr_offset;
 unsigned int get_kernel_sp(void);
 /**
@@ -33,18 +35,6 @@ unsigned int get_kernel_sp(void);
  */
 void dispatch_init(tcb_t* idle)
 {
-	unsigned int *p = 0xA2FFFAF0;
-	*p = 0;
-	/*
-	 * compute the offset form the context to the kstack_high
-	 * in a tcb for future use
-	 */
-	kstack_high_offset = offsetof(tcb_t, kstack_high) - offsetof(tcb_t, context);
-//	kstack_high_offset = 4148;
-//	printf("offsetof(tcb_t, kstack_high) is %u\n", offsetof(tcb_t, kstack_high));
-//	printf("offsetof(tcb_t, context) is %u\n", offsetof(tcb_t, context));
-//	printf("dispatch_init kstack_high_offset is %u\n", kstack_high_offset);
-
 	ctx_lr_offset = offsetof(sched_context_t, lr);
 //	printf("offsetof(context, lr) is %u\n", ctx_lr_offset);
 	// call find_next to find next task
@@ -60,17 +50,18 @@ void dispatch_init(tcb_t* idle)
  * @brief Context switch to the highest priority task while saving off the 
  * current task state.
  *
- * This function needs to beexternally synchronized.
+ * This function needs to be externally synchronized: called in a critical
+ * section or from the interrupt path, with interrupts masked.
  * We could be switching from the idle task.  The priority searcher has been tuned
  * to return IDLE_PRIO for a completely empty run_queue case.
  */
-void dispatch_save(void)
+HOT void dispatch_save(void)
 {
 	uint8_t next_prio;
 	tcb_t *next_tcb, *saved_cur_tcb;
+	struct crit_state crit;
 
 //	printf("inside dispatch save\n");
-
 //	printf("added cur_tcb %u %p to run queue\n", cur_tcb->cur_prio, cur_tcb);
 	next_prio = highest_prio();
 	/*
@@ -84,6 +75,8 @@ void dispatch_save(void)
 //	printf(" d save: removed next_tcb %u %p from run queue\n", next_tcb->cur_prio, next_tcb);
 //	print_run_queue();
 	saved_cur_tcb = cur_tcb;
+	if(saved_cur_tcb->kstack[0] != STACK_CANARY)
+		kstack_overflow(saved_cur_tcb);
 	cur_tcb = next_tcb;
 #if 0
 	printf("before calling ctx sw full, cur->context is %p\n", &(saved_cur_tcb->context));
@@ -94,8 +87,10 @@ void dispatch_save(void)
 	hexdump(&next_tcb->context, 160);
 #endif
 //	disable_interrupts();
+	crit_suspend(&crit);
 	ctx_switch_full((volatile void *)(&(next_tcb->context)),
 					(volatile void *)(&(saved_cur_tcb->context)));
+	crit_resume(&crit);
 //	while(1);
 }
 
@@ -120,6 +115,7 @@ void dispatch_nosave(void)
 //	printf("d nosave: removed next_tcb %u %p from run queue\n", next_tcb->cur_prio, next_tcb);
 //	print_run_queue();
 	cur_tcb = next_tcb;
+	crit_reset();
 //	printf("before calling ctx sw half, context->sp is %p\n", next_tcb->context.sp);
 	ctx_switch_half((volatile void *)(&(next_tcb->context)));
 }
@@ -129,12 +125,14 @@ void dispatch_nosave(void)
  * @brief Context switch to the highest priority task that is not this task -- 
  * and save the current task but don't mark is runnable.
  *
- * There is always an idle task to switch to.
+ * There is always an idle task to switch to.  Called in the critical section
+ * that queued the task wherever it sleeps.
  */
-void dispatch_sleep(void)
+HOT void dispatch_sleep(void)
 {
 	uint8_t next_prio;
 	tcb_t *next_tcb, *saved_cur_tcb;
+	struct crit_state crit;
 
 //	printf("inside dispatch sleep\n");
 	next_prio = highest_prio();
@@ -144,6 +142,8 @@ void dispatch_sleep(void)
 //	printf("d sleep: removed next_tcb %u %p from run queue\n", next_tcb->cur_prio, next_tcb);
 //	print_run_queue();
 	saved_cur_tcb = cur_tcb;
+	if(saved_cur_tcb->kstack[0] != STACK_CANARY)
+		kstack_overflow(saved_cur_tcb);
 	cur_tcb = next_tcb;
 //	printf("before calling ctx sw full, next->context->sp is %p\n", next_tcb->context.sp);
 //	printf("before calling ctx sw full, cur->context->sp is %p\n", saved_cur_tcb->context.sp);
@@ -152,8 +152,10 @@ void dispatch_sleep(void)
 //	disable_interrupts();
 //	printf("inside dispatch sleep hexdump of cur->context is\n");
 //	hexdump(&saved_cur_tcb->context, 160);
+	crit_suspend(&crit);
 	ctx_switch_full((volatile void *)(&(next_tcb->context)),
 					(volatile void *)(&(saved_cur_tcb->context)));
+	crit_resume(&crit);
 //	while(1);
 	
 }
@@ -161,21 +163,25 @@ void dispatch_sleep(void)
 /**
  * @brief Returns the priority value of the current task.
  */
-uint8_t get_cur_prio(void)
+HOT uint8_t get_cur_prio(void)
 {
 	return cur_tcb->cur_prio;
 }
 
 /**
- * @brief Returns the TCB of the current task.
+ * @brief Returns the native priority of the current task, or 0 -- which no
+ * task has -- for code that runs before the first task_create.  Per-task
+ * tables indexed by it give boot code a slot of its own.
  */
-tcb_t* get_cur_tcb(void)
+HOT uint8_t get_cur_native_prio(void)
 {
-	return cur_tcb;	
+	return cur_tcb != NULL ? cur_tcb->native_prio : 0;
 }
 
-void debug_print(void)
+/**
+ * @brief Returns the TCB of the current task.
+ */
+HOT tcb_t* get_cur_tcb(void)
 {
-	unsigned int *p = 0xA2FFFAF0;
-	*p += 1;
+	return cur_tcb;	
 }
@@ -11,7 +11,9 @@
 
 #include <kernel.h>
 #include <sched.h>
+#include <crit.h>
 #include "sched_i.h"
+#include <section.h>
 
 #define GROUP_SHIFT 3
 #define TASK_POSITION_MASK 0x7
@@ -75,11 +77,13 @@ void runqueue_init(void)
  *
  * The native priority of the thread need not be the specified priority.  The
  * only requirement is that the run queue for that priority is empty.  This
- * function needs to be externally synchronized.
+ * function needs to be externally synchronized.  A task above the current
+ * one preempts it at the next preemption point.
  */
-void runqueue_add(tcb_t* tcb, uint8_t prio)
+HOT void runqueue_add(tcb_t* tcb, uint8_t prio)
 {
 	uint8_t ostcbx, ostcby;
+	tcb_t *cur_tcb;
 	// add to run list
 	run_list[prio] = tcb;
 
@@ -90,6 +94,10 @@ void runqueue_add(tcb_t* tcb, uint8_t prio)
 	// add to the run_bits
 	ostcbx = prio & TASK_POSITION_MASK;
 	run_bits[ostcby] |= (0x1 << ostcbx); 	
+
+	cur_tcb = get_cur_tcb();
+	if(cur_tcb != NULL && prio < cur_tcb->cur_prio)
+		crit_preempt();
 }
 
 
@@ -100,7 +108,7 @@ void runqueue_add(tcb_t* tcb, uint8_t prio)
  *
  * This function needs to be externally synchronized.
  */
-tcb_t* runqueue_remove(uint8_t prio)
+HOT tcb_t* runqueue_remove(uint8_t prio)
 {
 	uint8_t ostcbx, ostcby;
 	tcb_t *return_tcb = NULL;
@@ -127,7 +135,7 @@ tcb_t* runqueue_remove(uint8_t prio)
  * @brief This function examines the run bits and the run queue and returns the
  * priority of the runnable task with the highest priority (lower number).
  */
-uint8_t highest_prio(void)
+HOT uint8_t highest_prio(void)
 {
 	uint8_t x, y, prio;
 
@@ -142,7 +150,7 @@ uint8_t highest_prio(void)
 	return prio;
 }
 
-void print_run_queue()
+COLD void print_run_queue()
 {
 	int i;
 	printf("RUN LIST\n");
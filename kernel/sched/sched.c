@@ -17,11 +17,28 @@
 #include <arm/psr.h>
 #include <arm/exception.h>
 #include <arm/physmem.h>
+#include <slab.h>
+#include <bits/errno.h>
 
 // TODO: REMOVE THIS
 #include <arm/timer.h>
-tcb_t system_tcb[OS_MAX_TASKS]; /*allocate memory for system TCBs */
-uint32_t *idle_count = 0xa2fffaf0;
+#include <section.h>
+static slab_cache_t tcb_cache; /* every TCB on the system */
+
+/* kernel stacks of the current task set, handed out bottom up from the
+ * first kstack_limit bytes */
+static uint32_t kstack_pool[OS_KSTACK_POOL/sizeof(uint32_t)] 
+                    __attribute__((aligned(8)));
+static size_t kstack_used;
+static size_t kstack_limit;
+
+/* painted user stack of each task by native priority, NULL low if untracked */
+static struct ustack
+{
+	uint32_t* low;
+	uint32_t* high;
+} ustacks[OS_MAX_TASKS];
+static uint32_t idle_count;     /* idle loops run, bumped from user mode */
 
 /**
  * @brief This is the idle task that the system runs when no other task is runnable
@@ -29,12 +46,29 @@ uint32_t *idle_count = 0xa2fffaf0;
  
 static void idle(void) 
 {
-	*idle_count = *idle_count + 1;
+	idle_count++;
 	enable_interrupts();
 	while(1);
 }
 
 
+static void stack_paint(uint32_t* low, uint32_t* high)
+{
+	while(low < high)
+		*low++ = STACK_PAINT;
+}
+
+/**
+ * @brief Bytes between high and the lowest word that no longer holds the
+ * paint.  Linear in the stack size -- only for reports.
+ */
+static size_t stack_peak(const uint32_t* low, const uint32_t* high)
+{
+	while(low < high && *low == STACK_PAINT)
+		low++;
+	return (high - low) * sizeof(uint32_t);
+}
+
 void setup_task_context(task_t *task, tcb_t *tcb, uint8_t prio)
 {
     sched_context_t *context = &(tcb->context);
@@ -49,28 +83,187 @@ void setup_task_context(task_t *task, tcb_t *tcb, uint8_t prio)
 
 	printf("after setting up context %u %u %u sp is %u \n", (tcb->context).r4, (tcb->context).r5, (tcb->context).r6, (tcb->context).sp);
 	printf("tcb->kstack_high is %x\n", (uint32_t)tcb->kstack_high);
-	printf("&(tcb->kstack_high) is %x\n", (uint32_t)(&(tcb->kstack_high)));
 	tcb->holds_lock = 0;
 	tcb->sleep_queue = NULL;
+	tcb->sleep_pprev = NULL;
+
+	/*
+	 * paint the part of the user stack the task asked us to track
+	 */
+	ustacks[prio].high = (uint32_t *)((uintptr_t)task->stack_pos & ~3);
+	ustacks[prio].low = NULL;
+	if(task->ustack_size != 0) {
+		ustacks[prio].low = ustacks[prio].high 
+		                    - task->ustack_size/sizeof(uint32_t);
+		stack_paint(ustacks[prio].low, ustacks[prio].high);
+	}
+}
+
+/**
+ * @brief Allocates a TCB together with a kernel stack of the given size.
+ *
+ * @param kstack_size  Stack bytes, or 0 for OS_KSTACK_SIZE.
+ *
+ * @return The TCB, or NULL if either the TCB cache or the stack pool is
+ *         exhausted.
+ */
+static tcb_t* tcb_alloc(size_t kstack_size)
+{
+	tcb_t *tcb;
+
+	if(kstack_size == 0)
+		kstack_size = OS_KSTACK_SIZE;
+	kstack_size = (kstack_size + 7) & ~7;
+	if(kstack_size > kstack_limit - kstack_used)
+		return NULL;
+
+	tcb = slab_alloc(&tcb_cache);
+	if(tcb == NULL)
+		return NULL;
+
+	tcb->kstack = kstack_pool + kstack_used/sizeof(uint32_t);
+	kstack_used += kstack_size;
+	tcb->kstack_high = kstack_pool + kstack_used/sizeof(uint32_t);
+	stack_paint(tcb->kstack, tcb->kstack_high);
+	tcb->kstack[0] = STACK_CANARY;
+	return tcb;
+}
+
+static void tcb_stack_usage(tcb_t* tcb, stack_usage_t* u)
+{
+	struct ustack *us = &ustacks[tcb->native_prio];
+
+	u->prio = tcb->native_prio;
+	u->kstack_size = (tcb->kstack_high - tcb->kstack)*sizeof(uint32_t);
+	/* the canary word is never part of the usable stack */
+	u->kstack_peak = stack_peak(tcb->kstack + 1, tcb->kstack_high);
+	u->ustack_size = 0;
+	u->ustack_peak = 0;
+	if(us->low != NULL) {
+		u->ustack_size = (us->high - us->low)*sizeof(uint32_t);
+		u->ustack_peak = stack_peak(us->low, us->high);
+	}
+}
+
+/**
+ * @brief Fills in the peak stack usage of up to count tasks, idle included.
+ *
+ * @return The number of entries filled in.
+ */
+size_t sched_stack_usage(stack_usage_t* usage, size_t count)
+{
+	unsigned int i;
+	size_t n = 0;
+	tcb_t *tcb;
+
+	for(i = 0; i < tcb_cache.capacity && n < count; i++) {
+		tcb = slab_object(&tcb_cache, i);
+		if(tcb != NULL)
+			tcb_stack_usage(tcb, &usage[n++]);
+	}
+	return n;
 }
 
-void sched_init(task_t* main_task)
+/**
+ * @brief Prints the stack sizes and peak usage of every task.  task_create
+ * reports the layout of a new set with it, and a kernel stack overflow the
+ * usage that led up to it.
+ */
+COLD void stack_dump(void)
+{
+	stack_usage_t u;
+	unsigned int i;
+	tcb_t *tcb;
+
+	printf("prio  kstack  kpeak  ustack  upeak\n");
+	for(i = 0; i < tcb_cache.capacity; i++) {
+		tcb = slab_object(&tcb_cache, i);
+		if(tcb == NULL)
+			continue;
+		tcb_stack_usage(tcb, &u);
+		printf("%4lu  %6lu  %5lu  %6lu  %5lu\n", u.prio, u.kstack_size,
+		       u.kstack_peak, u.ustack_size, u.ustack_peak);
+	}
+}
+
+/**
+ * @brief Called when a task's kernel stack canary has been overwritten.
+ */
+COLD void kstack_overflow(tcb_t* tcb)
 {
-	*idle_count = 0;
+	printf("kernel stack overflow in task %u\n", tcb->native_prio);
+	stack_dump();
+	panic("kstack");
+}
+
+/**
+ * @brief Carves room for count TCBs, idle included, out of the slab region
+ * and budgets count default-sized kernel stacks out of the stack pool.
+ * Tasks may split the budget into stacks of other sizes.
+ *
+ * Called once at boot.
+ */
+int sched_mem_init(unsigned int count)
+{
+	if(count > OS_KSTACK_POOL / OS_KSTACK_SIZE)
+		return -ENOMEM;
+	kstack_limit = count * OS_KSTACK_SIZE;
+	return slab_create(&tcb_cache, "tcb", sizeof(struct tcb), count);
+}
+
+/**
+ * @brief Checks that num_tasks tasks and the idle task fit in the TCB cache
+ * and the kernel stack pool, so that allocate_tasks and sched_init cannot
+ * fail once the previous task set is torn down.
+ *
+ * @return 0 if they fit, -ENOMEM if not.
+ */
+int sched_fits(const task_t* tasks, size_t num_tasks)
+{
+	size_t need = OS_KSTACK_SIZE, size;
+	unsigned int i;
+
+	if(num_tasks + 1 > tcb_cache.capacity)
+		return -ENOMEM;
+	for(i = 0; i < num_tasks; i++) {
+		size = tasks[i].kstack_size ? tasks[i].kstack_size : OS_KSTACK_SIZE;
+		need += (size + 7) & ~7;
+		if(need > kstack_limit)
+			return -ENOMEM;
+	}
+	return 0;
+}
+
+/**
+ * @brief Sets up the idle task and puts it on the run queue.
+ *
+ * @return The idle task's TCB, or NULL if no TCB is left for it.
+ */
+tcb_t* sched_init(task_t* main_task)
+{
+	tcb_t* idle_tcb = tcb_alloc(OS_KSTACK_SIZE);
+
+	if (idle_tcb == NULL)
+		return NULL;
+
+	idle_count = 0;
 	main_task->lambda = (task_fun_t)idle;
 	main_task->data = NULL;
-	main_task->stack_pos = system_tcb[IDLE_PRIO].kstack_high;
+	main_task->stack_pos = idle_tcb->kstack_high;
 	main_task->C = 0;
 	main_task->T = 0;
-	printf("setting stuff in idle's tcb %p\n", &system_tcb[IDLE_PRIO]);
+	main_task->kstack_size = OS_KSTACK_SIZE;
+	main_task->ustack_size = 0;   /* idle runs on its kernel stack */
+	printf("setting stuff in idle's tcb %p\n", idle_tcb);
 	// setup the context for the idle task
-	setup_task_context(main_task, &system_tcb[IDLE_PRIO], IDLE_PRIO);
-	runqueue_add(&system_tcb[IDLE_PRIO], IDLE_PRIO);
+	setup_task_context(main_task, idle_tcb, IDLE_PRIO);
+	runqueue_add(idle_tcb, IDLE_PRIO);
+	return idle_tcb;
 }
 
 /**
  * @brief Allocate user-stacks and initializes the kernel contexts of the
- * given threads.
+ * given threads, then makes them all runnable.
  *
  * This function assumes that:
  * - num_tasks < number of tasks allowed on the system.
@@ -78,14 +271,30 @@ void sched_init(task_t* main_task)
  *   scheduled.  In particular, this means that the task list is sorted in order
  *   of priority -- higher priority tasks come first.
  *
+ * The TCB cache and the stack pool are rewound first.  Nothing may be
+ * running on a kernel stack from the pool, which is why task_create refuses
+ * to run inside a task.
+ *
  * @param tasks  A list of scheduled task descriptors.
  * @param size   The number of tasks is the list.
+ *
+ * @return 0 on success, -ENOMEM if the TCB cache or the stack pool cannot
+ *         hold every task.
  */
-void allocate_tasks(task_t** tasks, size_t num_tasks)
+int allocate_tasks(task_t** tasks, size_t num_tasks)
 {
 	task_t *a_tasks = *tasks;
+	tcb_t *tcb;
 	unsigned int i;
+
+	slab_reset(&tcb_cache);
+	kstack_used = 0;
 	for(i = 0; i < num_tasks; i++) {
-		setup_task_context(&a_tasks[i], &system_tcb[i+1], i+1);
+		tcb = tcb_alloc(a_tasks[i].kstack_size);
+		if(tcb == NULL)
+			return -ENOMEM;
+		setup_task_context(&a_tasks[i], tcb, i+1);
+		runqueue_add(tcb, tcb->native_prio);
 	}
+	return 0;
 }
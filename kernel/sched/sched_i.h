@@ -11,16 +11,17 @@
 
 #include <sched.h>
 
+/* Unused stack words hold STACK_PAINT; the lowest kernel stack word holds
+ * STACK_CANARY and is checked whenever its task is switched out. */
+#define STACK_PAINT   0x5afe57acu
+#define STACK_CANARY  0xc0dec0deu
+
 
 void dispatch_init(tcb_t* idle);
+void kstack_overflow(tcb_t* tcb) __attribute__((noreturn));
 void runqueue_init(void);
 
 void ctx_switch_full(volatile void* next_ctx, volatile void* cur_ctx);
 void ctx_switch_half(volatile void* next_ctx) __attribute__((noreturn));
 
-/** A list of every TCB+kernel stack that can exist on this system.
- * Note -- this list is not ordered by anything.
- */
-extern tcb_t system_tcb[OS_MAX_TASKS];
-
 #endif /* _SCHED_I_H_ */
@@ -0,0 +1,113 @@
+/** @file sleep_queue.c
+ *
+ * @brief Sleep queue maintainence and timed sleeps.
+ *
+ * A sleep queue is a pointer to its first TCB.  Every queued TCB also
+ * records the link that points at it, so a task can be taken off whatever
+ * queue it is on in O(1) -- which is what a timeout needs, since it fires
+ * without knowing the queue.
+ */
+
+#include <types.h>
+#include <assert.h>
+
+#include <kernel.h>
+#include <sched.h>
+#include <ktimer.h>
+#include <bits/errno.h>
+#include "sched_i.h"
+#include <section.h>
+
+/* The state shared by a timed sleeper and its timer */
+struct sleep_timeout
+{
+	tcb_t* tcb;
+	int    expired;
+};
+
+/**
+ * @brief Puts tcb at the front of the queue.
+ */
+HOT void sleepq_push(tcb_t* volatile* head, tcb_t* tcb)
+{
+	tcb->sleep_queue = *head;
+	tcb->sleep_pprev = head;
+	if(tcb->sleep_queue != NULL)
+		tcb->sleep_queue->sleep_pprev = &tcb->sleep_queue;
+	*head = tcb;
+}
+
+/**
+ * @brief Puts tcb at the back of the queue.  Linear in the queue length.
+ */
+void sleepq_append(tcb_t* volatile* head, tcb_t* tcb)
+{
+	while(*head != NULL)
+		head = &(*head)->sleep_queue;
+	sleepq_push(head, tcb);
+}
+
+/**
+ * @brief Takes tcb off the queue it is on.
+ */
+HOT void sleepq_remove(tcb_t* tcb)
+{
+	assert(tcb->sleep_pprev != NULL);
+
+	*tcb->sleep_pprev = tcb->sleep_queue;
+	if(tcb->sleep_queue != NULL)
+		tcb->sleep_queue->sleep_pprev = tcb->sleep_pprev;
+	tcb->sleep_queue = NULL;
+	tcb->sleep_pprev = NULL;
+}
+
+/**
+ * @brief Takes the first task off the queue.
+ *
+ * @return The task, or NULL if the queue is empty.
+ */
+HOT tcb_t* sleepq_pop(tcb_t* volatile* head)
+{
+	tcb_t* tcb = *head;
+
+	if(tcb != NULL)
+		sleepq_remove(tcb);
+	return tcb;
+}
+
+/*
+ * timer callback: wake the sleeper unless someone else already has
+ */
+static void sleep_expire(void* arg)
+{
+	struct sleep_timeout* s = arg;
+
+	if(s->tcb->sleep_pprev == NULL)
+		return;
+
+	sleepq_remove(s->tcb);
+	s->expired = 1;
+	runqueue_add(s->tcb, s->tcb->cur_prio);
+}
+
+/**
+ * @brief Like dispatch_sleep, but gives up at the deadline tick.
+ *
+ * The current task must already be on a sleep queue, queued in the critical
+ * section this is called in; on timeout it is taken off again.
+ *
+ * @return 0 if the task was woken, -ETIMEDOUT if the deadline passed first.
+ */
+int dispatch_sleep_timeout(unsigned long deadline)
+{
+	struct sleep_timeout s;
+	struct ktimer timer;
+
+	s.tcb = get_cur_tcb();
+	s.expired = 0;
+	ktimer_add(&timer, deadline, sleep_expire, &s);
+	dispatch_sleep();
+	ktimer_cancel(&timer);
+
+	return s.expired ? -ETIMEDOUT : 0;
+}
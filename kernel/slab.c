@@ -0,0 +1,173 @@
+/** @file slab.c
+ *
+ * @brief Fixed-size object caches carved from a boot-time region.
+ *
+ * Caches are never destroyed, so carving is a bump pointer through
+ * slab_region.  Within a cache, object i is free iff bit (31 - i % 32) of
+ * map[i / 32] is set, and map word w has free objects iff bit (31 - w) of
+ * summary is set.  Storing the bits MSB-first lets count-leading-zeros
+ * return the lowest free index directly.
+ */
+
+#include <types.h>
+#include <assert.h>
+#include <config.h>
+#include <slab.h>
+#include <bits/errno.h>
+#include <exports.h>
+#include <section.h>
+
+#define MSB  0x80000000u
+
+static char slab_region[OS_SLAB_SIZE] __attribute__((aligned(SLAB_LINE)));
+static size_t slab_used;
+static slab_cache_t* slab_caches;
+
+/**
+ * @brief Forgets every cache and makes the whole region available again.
+ */
+void slab_init(void)
+{
+	slab_used = 0;
+	slab_caches = NULL;
+}
+
+/**
+ * @brief Carves a cache of count objects of the given size.
+ *
+ * @return 0 on success, -ENOMEM if the region or the bitmap is too small.
+ */
+int slab_create(slab_cache_t* cache, const char* name, size_t size,
+                unsigned int count)
+{
+	size = (size + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+	slab_used = (slab_used + SLAB_LINE - 1) & ~(SLAB_LINE - 1);
+	if (count == 0 || count > SLAB_MAX_OBJS
+	    || size * count > OS_SLAB_SIZE - slab_used) {
+		printf("slab: no room for %u %s objects\n", count, name);
+		return -ENOMEM;
+	}
+
+	cache->name = name;
+	cache->objs = slab_region + slab_used;
+	cache->obj_size = size;
+	cache->capacity = count;
+	slab_used += size * count;
+
+	slab_reset(cache);
+	cache->high_water = 0;
+	cache->failures = 0;
+
+	cache->next = slab_caches;
+	slab_caches = cache;
+	return 0;
+}
+
+/**
+ * @brief Marks every object in the cache free.
+ */
+void slab_reset(slab_cache_t* cache)
+{
+	unsigned int w, left = cache->capacity;
+
+	cache->summary = 0;
+	for (w = 0; w < SLAB_MAP_WORDS; w++) {
+		if (left >= 32)
+			cache->map[w] = ~0u;
+		else
+			cache->map[w] = left ? ~(~0u >> left) : 0;
+		left -= (left >= 32) ? 32 : left;
+		if (cache->map[w])
+			cache->summary |= MSB >> w;
+	}
+	cache->in_use = 0;
+}
+
+/**
+ * @brief Takes the lowest-numbered free object in O(1).
+ *
+ * @return The object, or NULL if the cache is exhausted.
+ */
+void* slab_alloc(slab_cache_t* cache)
+{
+	unsigned int w, b;
+
+	if (!cache->summary) {
+		cache->failures++;
+		return NULL;
+	}
+
+	w = __builtin_clz(cache->summary);
+	b = __builtin_clz(cache->map[w]);
+	cache->map[w] &= ~(MSB >> b);
+	if (!cache->map[w])
+		cache->summary &= ~(MSB >> w);
+
+	if (++cache->in_use > cache->high_water)
+		cache->high_water = cache->in_use;
+
+	return cache->objs + (w * 32 + b) * cache->obj_size;
+}
+
+/**
+ * @brief Returns an object to its cache.  Freeing NULL does nothing.
+ */
+void slab_free(slab_cache_t* cache, void* obj)
+{
+	unsigned int i;
+
+	if (obj == NULL)
+		return;
+
+	i = slab_index(cache, obj);
+	assert(i < cache->capacity);
+	assert(!(cache->map[i / 32] & (MSB >> (i % 32))));
+
+	cache->map[i / 32] |= MSB >> (i % 32);
+	cache->summary |= MSB >> (i / 32);
+	cache->in_use--;
+}
+
+/**
+ * @brief Converts an object into a small integer, e.g. for a syscall handle.
+ *
+ * @return The index, or the cache capacity if obj is not one of its objects.
+ */
+unsigned int slab_index(const slab_cache_t* cache, const void* obj)
+{
+	size_t off = (const char*)obj - cache->objs;
+
+	if ((const char*)obj < cache->objs || off % cache->obj_size)
+		return cache->capacity;
+	off /= cache->obj_size;
+	return off < cache->capacity ? off : cache->capacity;
+}
+
+/**
+ * @brief The inverse of slab_index.
+ *
+ * @return The allocated object with this index, or NULL if the index is out
+ *         of range or the object is free.
+ */
+void* slab_object(const slab_cache_t* cache, unsigned int index)
+{
+	if (index >= cache->capacity
+	    || (cache->map[index / 32] & (MSB >> (index % 32))))
+		return NULL;
+	return cache->objs + index * cache->obj_size;
+}
+
+/**
+ * @brief Prints per-cache usage and the state of the region.
+ */
+COLD void slab_dump(void)
+{
+	slab_cache_t* c;
+
+	printf("slab: %lu of %u bytes carved\n", slab_used, OS_SLAB_SIZE);
+	printf("%-8s %6s %6s %6s %6s %6s\n", "cache", "size", "total", "used",
+	       "peak", "fail");
+	for (c = slab_caches; c; c = c->next)
+		printf("%-8s %6lu %6u %6u %6u %6u\n", c->name, c->obj_size,
+		       c->capacity, c->in_use, c->high_water, c->failures);
+}
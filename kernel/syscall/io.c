@@ -9,12 +9,18 @@
 #include <types.h>
 #include <bits/errno.h>
 #include <bits/fileno.h>
+#include <bits/uio.h>
+#include <bits/fcntl.h>
+#include <config.h>
 #include <arm/physmem.h>
 #include <syscall.h>
 #include <exports.h>
 #include <kernel.h>
+#include <sched.h>
+#include <ktimer.h>
 #include <arm/psr.h>
 #include <arm/exception.h>
+#include <arm/uart.h>
 
 #define EOT_CHAR 0x04
 #define DEL_CHAR 0x7f
@@ -22,43 +28,115 @@
 #define MAX_BUF_SIZE 0x4000000   // 64 MB max buffer size
 #define SDRAM_RANGE_END 0xa4000000
 
+/* the only flag a descriptor can carry */
+#define FD_FLAGS O_NONBLOCK
+
+/* status flags of STDIN_FILENO and STDOUT_FILENO, per task native priority;
+ * boot code before the first task_create uses slot 0 */
+static unsigned long fd_flags[OS_MAX_TASKS][STDOUT_FILENO + 1];
+
 /*
- * implementation of the read syscall
- * @param: fd - file descriptor
- * @param: buf - user task buffer pointer
- * @param: count - number of bytes the user task wants to read
- * @return ssize_t - number of bytes read on success, < 0 on failure
+ * clears the descriptor flags of every task -- called for a new task set
+ * @param: void
+ * @return void
  */
-ssize_t read_syscall(int fd, void *buf, size_t count)
+void io_init(void)
 {
-	char ch;
-	ssize_t read_cnt = -1;
-	char *ubuf = buf;
-	/*
-	 * validate the fd argument
-	 */
-	if(fd != STDIN_FILENO) {
-	 	return -EBADF;
+	int i;
+
+	for(i = 0; i < OS_MAX_TASKS; i++) {
+		fd_flags[i][STDIN_FILENO] = 0;
+		fd_flags[i][STDOUT_FILENO] = 0;
 	}
+}
 
-	/*
-	 * validate the user supplied count
-	 */
-	if(count > MAX_BUF_SIZE) {
+/*
+ * status flags of the calling task's descriptor fd, which must be valid
+ */
+static unsigned long cur_fd_flags(int fd)
+{
+	return fd_flags[get_cur_native_prio()][fd];
+}
+
+/*
+ * copies a user iovec array to iov and checks every segment of the copy
+ * before any byte moves -- the task could rewrite its own array while the
+ * syscall waits or is preempted, so only the copy may be used afterwards
+ * @param: iov - kernel array of at least IOV_MAX entries
+ * @param: total - set to the sum of the segment lengths
+ * @return int - 0 if the whole array is usable, < 0 on failure
+ */
+static int iov_copy(struct iovec *iov, const struct iovec *uiov, int iovcnt,
+                    size_t *total)
+{
+	int i;
+
+	if(iovcnt <= 0 || iovcnt > IOV_MAX) {
+		return -EINVAL;
+	}
+
+	if(valid_addr(uiov, iovcnt * sizeof(*uiov), USR_START_ADDR,
+	              USR_END_ADDR) == 0) {
 		return -EFAULT;
 	}
-	  
-	/*
-	 * validate the range of buffer memory addresses
-	 */
-	if(((char *)ubuf + count) >= (char *)SDRAM_RANGE_END) {
-	    return -EFAULT;
+
+	*total = 0;
+	for(i = 0; i < iovcnt; i++) {
+		iov[i] = uiov[i];
+		if(iov[i].iov_len > MAX_BUF_SIZE - *total) {
+			return -EINVAL;
+		}
+		if(iov[i].iov_len != 0
+		   && valid_addr(iov[i].iov_base, iov[i].iov_len, USR_START_ADDR,
+		                 USR_END_ADDR) == 0) {
+			return -EFAULT;
+		}
+		*total += iov[i].iov_len;
+	}
+	return 0;
+}
+
+/*
+ * byte pos of the logical buffer formed by the segments, which must exist
+ */
+static char *iov_byte(const struct iovec *iov, size_t pos)
+{
+	while(pos >= iov->iov_len) {
+		pos -= iov->iov_len;
+		iov++;
 	}
+	return (char *)iov->iov_base + pos;
+}
+
+/* how read_line waits for input */
+#define READ_SPIN     0   /* spin in getc */
+#define READ_NONBLOCK 1   /* don't wait at all */
+#define READ_TIMED    2   /* sleep until input or the deadline */
+
+/*
+ * reads one line of at most count bytes from STDIN into the segments
+ * @param: wait - READ_SPIN, READ_NONBLOCK or READ_TIMED
+ * @param: deadline - tick at which READ_TIMED gives up
+ * @return ssize_t - number of bytes read, or -EAGAIN/-ETIMEDOUT if no byte
+ *                   arrived in time
+ */
+static ssize_t read_line(const struct iovec *iov, size_t count, int wait,
+                         unsigned long deadline)
+{
+	char ch;
+	ssize_t read_cnt = -1;
+	int ret;
 
 	/*
-	 * all set, read the bytes from STDIN and handle different cases
+	 * read the bytes from STDIN and handle different cases
 	 */
 	do {
+		if(wait != READ_SPIN && !tstc()) {
+			ret = (wait == READ_TIMED) ? poll_input(deadline) : -EAGAIN;
+			if(ret < 0) {
+				return (read_cnt > -1) ? (read_cnt + 1) : ret;
+			}
+		}
 		ch = (char)getc();
 		switch (ch) 
 		{
@@ -72,7 +150,7 @@ ssize_t read_syscall(int fd, void *buf, size_t count)
 				 * backspace or delete key was pressed
 				 */
 				if(read_cnt > -1) {
-					ubuf[read_cnt] = 0;
+					*iov_byte(iov, read_cnt) = 0;
 					read_cnt--;
 					putc('\b');
 					putc(' ');
@@ -86,7 +164,7 @@ ssize_t read_syscall(int fd, void *buf, size_t count)
 				 */
 				if((read_cnt + 1) < (ssize_t)count) {
 			    	read_cnt++;
-					ubuf[read_cnt] = '\n';
+					*iov_byte(iov, read_cnt) = '\n';
 					putc('\n');
 				} 
 				return (read_cnt + 1);
@@ -96,7 +174,7 @@ ssize_t read_syscall(int fd, void *buf, size_t count)
 				 */
 				if((read_cnt + 1) < (ssize_t)count) {
 			    	read_cnt++;
-					ubuf[read_cnt] = ch;
+					*iov_byte(iov, read_cnt) = ch;
 					putc(ch);
 				} else {
 					return (read_cnt + 1);
@@ -105,10 +183,123 @@ ssize_t read_syscall(int fd, void *buf, size_t count)
 	} while(1);	
 }
 
+/*
+ * writes count bytes of buf to STDOUT, stopping early at a NUL
+ * @param: nonblock - stop rather than wait once the UART FIFO is full
+ * @return ssize_t - number of bytes written, or -EAGAIN if nonblock is set
+ *                   and not even the first byte fit
+ */
+static ssize_t write_bytes(const char *buf, size_t count, int nonblock)
+{
+	ssize_t write_cnt = 0;
+
+	while((write_cnt < (ssize_t)count) && (buf[write_cnt] != '\0')) {
+		if(nonblock && !uart_tx_ready()) {
+			return (write_cnt > 0) ? write_cnt : -EAGAIN;
+		}
+		putc(buf[write_cnt++]);
+	}
+	return write_cnt;
+}
+
+/*
+ * implementation of the read syscall
+ * @param: fd - file descriptor
+ * @param: buf - user task buffer pointer
+ * @param: count - number of bytes the user task wants to read
+ * @return ssize_t - number of bytes read on success, < 0 on failure
+ */
+ssize_t read_syscall(int fd, void *buf, size_t count)
+{
+	struct iovec iov;
+
+	/*
+	 * validate the fd argument
+	 */
+	if(fd != STDIN_FILENO) {
+	 	return -EBADF;
+	}
+
+	/*
+	 * validate the user supplied count
+	 */
+	if(count > MAX_BUF_SIZE) {
+		return -EFAULT;
+	}
+	  
+	/*
+	 * validate the range of buffer memory addresses -- the kernel writes
+	 * here, so only user memory below the time page will do
+	 */
+	if(valid_addr(buf, count, USR_START_ADDR, USR_END_ADDR) == 0) {
+	    return -EFAULT;
+	}
+
+	/*
+	 * all set, read one line into the buffer
+	 */
+	iov.iov_base = buf;
+	iov.iov_len = count;
+	return read_line(&iov, count, 
+	                 (cur_fd_flags(fd) & O_NONBLOCK) ? READ_NONBLOCK : READ_SPIN,
+	                 0);
+}
+
+/*
+ * implementation of the read_timeout syscall: read, but sleep rather than
+ * spin while waiting for input, and give up after millis milliseconds
+ * @return ssize_t - number of bytes read on success, -ETIMEDOUT if none
+ *                   arrived in time, < 0 on other failures
+ */
+ssize_t read_timeout_syscall(int fd, void *buf, size_t count,
+                             unsigned long millis)
+{
+	struct iovec iov;
+
+	if(fd != STDIN_FILENO) {
+	 	return -EBADF;
+	}
+
+	if(count > MAX_BUF_SIZE
+	   || valid_addr(buf, count, USR_START_ADDR, USR_END_ADDR) == 0) {
+		return -EFAULT;
+	}
+
+	iov.iov_base = buf;
+	iov.iov_len = count;
+	return read_line(&iov, count,
+	                 (cur_fd_flags(fd) & O_NONBLOCK) ? READ_NONBLOCK : READ_TIMED,
+	                 ktimer_deadline(millis));
+}
+
+/*
+ * implementation of the readv syscall: read, scattered over the segments
+ * @param: uiov - user array of iovcnt segments, filled in order
+ * @return ssize_t - number of bytes read on success, < 0 on failure
+ */
+ssize_t readv_syscall(int fd, const struct iovec *uiov, int iovcnt)
+{
+	struct iovec iov[IOV_MAX];
+	size_t total;
+	int ret;
+
+	if(fd != STDIN_FILENO) {
+	 	return -EBADF;
+	}
+
+	ret = iov_copy(iov, uiov, iovcnt, &total);
+	if(ret < 0) {
+		return ret;
+	}
+
+	return read_line(iov, total, 
+	                 (cur_fd_flags(fd) & O_NONBLOCK) ? READ_NONBLOCK : READ_SPIN,
+	                 0);
+}
+
 /* Write count bytes to fd from the buffer buf. */
 ssize_t write_syscall(int fd, const void *buf, size_t count)
 {
-	ssize_t write_cnt = 0;
 	const char *ubuf = buf;
 //	enable_interrupts();
 //	printf("INSIDE WRITE SYSCALL enabled interrupts\n");
@@ -136,11 +327,78 @@ ssize_t write_syscall(int fd, const void *buf, size_t count)
 	/*
 	 * all set, write out the buffer to STDOUT
 	 */
-	 while((write_cnt < (ssize_t)count) && (ubuf[write_cnt] != '\0')) {
-	 	putc(ubuf[write_cnt++]);
-	}
 //	printf("INSIDE WRITE SYSCALL disabled interrupts\n");
 //	disable_interrupts();
-	return write_cnt;	
+	return write_bytes(ubuf, count, cur_fd_flags(fd) & O_NONBLOCK);
 }
 
+/*
+ * implementation of the writev syscall: write, gathered from the segments
+ * @param: uiov - user array of iovcnt segments, written in order
+ * @return ssize_t - number of bytes written on success, < 0 on failure
+ */
+ssize_t writev_syscall(int fd, const struct iovec *uiov, int iovcnt)
+{
+	struct iovec iov[IOV_MAX];
+	ssize_t write_cnt = 0, n;
+	size_t total;
+	int i, ret;
+
+	if(fd != STDOUT_FILENO) {
+		return -EBADF;
+	}
+
+	ret = iov_copy(iov, uiov, iovcnt, &total);
+	if(ret < 0) {
+		return ret;
+	}
+
+	/*
+	 * like write, a NUL or a full FIFO in non-blocking mode ends the output
+	 * early
+	 */
+	for(i = 0; i < iovcnt; i++) {
+		n = write_bytes(iov[i].iov_base, iov[i].iov_len,
+		                cur_fd_flags(fd) & O_NONBLOCK);
+		if(n < 0) {
+			return (write_cnt > 0) ? write_cnt : n;
+		}
+		write_cnt += n;
+		if(n < (ssize_t)iov[i].iov_len) {
+			break;
+		}
+	}
+	return write_cnt;
+}
+
+/*
+ * implementation of the fcntl syscall, for the status flags only
+ * @param: cmd - F_GETFL or F_SETFL
+ * @param: arg - the new flags for F_SETFL
+ * @return int - the flags for F_GETFL, 0 for F_SETFL, < 0 on failure
+ *
+ * O_NONBLOCK on STDOUT_FILENO makes write and writev stop at a full UART
+ * FIFO, returning the bytes written so far, or -EAGAIN if there were none,
+ * instead of waiting for the FIFO to drain.
+ */
+int fcntl_syscall(int fd, int cmd, unsigned long arg)
+{
+	uint8_t prio = get_cur_native_prio();
+
+	if(fd != STDIN_FILENO && fd != STDOUT_FILENO) {
+		return -EBADF;
+	}
+
+	switch(cmd) {
+		case F_GETFL:
+			return fd_flags[prio][fd];
+		case F_SETFL:
+			if(arg & ~FD_FLAGS) {
+				return -EINVAL;
+			}
+			fd_flags[prio][fd] = arg;
+			return 0;
+		default:
+			return -EINVAL;
+	}
+}
@@ -0,0 +1,265 @@
+/** @file poll.c
+ *
+ * @brief Waiting on the console and several devices at once.
+ *
+ * A polling task sleeps with one waiter record on its kernel stack that
+ * names every source it is interested in.  The device code offers the
+ * devices that signalled in a tick to the waiters, the tick wakes waiters
+ * whose console input has arrived, and a kernel timer wakes a waiter whose
+ * timeout has run out.  A waiter is unlinked when it is woken, so it is made
+ * runnable exactly once no matter how many of its sources become ready in
+ * the same tick.
+ */
+
+#include <types.h>
+#include <config.h>
+#include <kernel.h>
+#include <syscall.h>
+#include <sched.h>
+#include <device.h>
+#include <exports.h>
+#include <arm/timer.h>
+#include <ktimer.h>
+#include <crit.h>
+#include <bits/errno.h>
+#include <bits/fileno.h>
+#include <bits/poll.h>
+
+struct poll_waiter
+{
+	tcb_t*               tcb;
+	unsigned long        devs;      /**< Bit per device polled for POLLIN */
+	unsigned long        fired;     /**< Devices that signalled while asleep */
+	int                  input;     /**< Wake when console input is pending */
+	int                  expired;   /**< The timeout has run out */
+	struct poll_waiter*  next;
+	struct poll_waiter** pprev;     /**< Link pointing at us, NULL if awake */
+};
+
+/* Sleeping pollers, most recent first */
+static struct poll_waiter* pollers;
+
+/**
+ * @brief Forgets every waiter -- called for a new task set.
+ */
+void poll_init(void)
+{
+	pollers = NULL;
+}
+
+static void poll_sleep(struct poll_waiter* w)
+{
+	ring_block();
+	crit_enter();
+	/* the timeout may have run out since the caller looked */
+	if(w->expired) {
+		crit_exit();
+		return;
+	}
+	w->next = pollers;
+	w->pprev = &pollers;
+	if(w->next != NULL)
+		w->next->pprev = &w->next;
+	pollers = w;
+	if(w->input)
+		timer_due_by(get_ticks() + 1);
+	dispatch_sleep();
+	crit_exit();
+}
+
+/* unlinks the sleeping waiter w and makes its task runnable */
+static void poll_wake(struct poll_waiter* w)
+{
+	*w->pprev = w->next;
+	if(w->next != NULL)
+		w->next->pprev = w->pprev;
+	w->pprev = NULL;
+	runqueue_add(w->tcb, w->tcb->cur_prio);
+}
+
+/* timer callback -- the waiter may be awake already, between two sleeps */
+static void poll_expire(void* arg)
+{
+	struct poll_waiter* w = arg;
+
+	w->expired = 1;
+	if(w->pprev != NULL)
+		poll_wake(w);
+}
+
+/**
+ * @brief Wakes the waiters polling any of the devices in fired, a bit per
+ * device that signalled this tick.  Called from dev_update.
+ */
+void poll_dev_event(unsigned long fired)
+{
+	struct poll_waiter *w, *next;
+
+	for(w = pollers; w != NULL; w = next) {
+		next = w->next;
+		if(w->devs & fired) {
+			w->fired |= w->devs & fired;
+			poll_wake(w);
+		}
+	}
+}
+
+/**
+ * @brief Wakes the waiters whose console input arrived.  Called on every
+ * timer tick.
+ */
+void poll_tick(void)
+{
+	struct poll_waiter *w, *next;
+
+	if(pollers == NULL || !tstc()) {
+		return;
+	}
+
+	for(w = pollers; w != NULL; w = next) {
+		next = w->next;
+		if(w->input) {
+			poll_wake(w);
+		}
+	}
+}
+
+/**
+ * @brief Whether a sleeping waiter needs poll_tick to look at the console.
+ */
+int poll_wants_input(void)
+{
+	struct poll_waiter* w;
+
+	for(w = pollers; w != NULL; w = w->next) {
+		if(w->input)
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * fills in revents and records in w what to wait for
+ * @return int - the number of descriptors with revents set
+ */
+static int poll_scan(struct pollfd* fds, unsigned long nfds,
+                     struct poll_waiter* w)
+{
+	unsigned long i;
+	unsigned int dev;
+	int ready = 0;
+
+	for(i = 0; i < nfds; i++) {
+		fds[i].revents = 0;
+		if(fds[i].fd < 0) {
+			continue;
+		}
+
+		if(fds[i].fd == STDIN_FILENO) {
+			if(fds[i].events & POLLIN) {
+				w->input = 1;
+				if(tstc()) {
+					fds[i].revents = POLLIN;
+				}
+			}
+		} else if(fds[i].fd == STDOUT_FILENO) {
+			fds[i].revents = fds[i].events & POLLOUT;
+		} else if(fds[i].fd >= DEV_FILENO(0)
+		          && fds[i].fd < DEV_FILENO(NUM_DEVICES)) {
+			dev = fds[i].fd - DEV_FILENO(0);
+			if(fds[i].events & POLLIN) {
+				w->devs |= 1u << dev;
+				if(w->fired & (1u << dev)) {
+					fds[i].revents = POLLIN;
+				}
+			}
+		} else {
+			fds[i].revents = POLLNVAL;
+		}
+
+		if(fds[i].revents) {
+			ready++;
+		}
+	}
+	return ready;
+}
+
+/*
+ * implementation of the poll syscall
+ * @param: fds - user array of nfds descriptors
+ * @param: timeout - milliseconds to wait, < 0 for ever, 0 to only check
+ * @return int - number of ready descriptors, 0 on timeout, < 0 on failure
+ *
+ * A device descriptor is ready when the device fires while the caller
+ * sleeps here, just as event_wait would have returned.
+ */
+int poll_syscall(struct pollfd* fds, unsigned long nfds, int timeout)
+{
+	struct poll_waiter w;
+	struct ktimer timer;
+	int ready;
+
+	if(nfds > POLL_MAX) {
+		return -EINVAL;
+	}
+	if(nfds != 0 && valid_addr(fds, nfds * sizeof(*fds), USR_START_ADDR,
+	                           USR_END_ADDR) == 0) {
+		return -EFAULT;
+	}
+
+	w.tcb = get_cur_tcb();
+	w.devs = 0;
+	w.fired = 0;
+	w.input = 0;
+	w.expired = (timeout == 0);
+	w.pprev = NULL;
+	if(timeout > 0) {
+		crit_enter();
+		ktimer_add(&timer, ktimer_deadline(timeout), poll_expire, &w);
+		crit_exit();
+	}
+
+	/*
+	 * sleep until a source or the timer wakes us
+	 */
+	while((ready = poll_scan(fds, nfds, &w)) == 0 && !w.expired) {
+		poll_sleep(&w);
+	}
+
+	if(timeout > 0) {
+		crit_enter();
+		ktimer_cancel(&timer);
+		crit_exit();
+	}
+	return ready;
+}
+
+/**
+ * @brief Sleeps until console input is pending or the deadline tick.
+ *
+ * @return 0 if input is pending, -ETIMEDOUT otherwise.
+ */
+int poll_input(unsigned long deadline)
+{
+	struct poll_waiter w;
+	struct ktimer timer;
+
+	w.tcb = get_cur_tcb();
+	w.devs = 0;
+	w.fired = 0;
+	w.input = 1;
+	w.expired = KTIMER_DUE(get_ticks(), deadline);
+	w.pprev = NULL;
+	crit_enter();
+	ktimer_add(&timer, deadline, poll_expire, &w);
+	crit_exit();
+
+	while(!tstc() && !w.expired) {
+		poll_sleep(&w);
+	}
+
+	crit_enter();
+	ktimer_cancel(&timer);
+	crit_exit();
+	return tstc() ? 0 : -ETIMEDOUT;
+}
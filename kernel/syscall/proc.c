@@ -10,6 +10,7 @@
  */
 
 #include <exports.h>
+#include <assert.h>
 #include <bits/errno.h>
 #include <config.h>
 #include <kernel.h>
@@ -23,10 +24,15 @@
 #include <arm/exception.h>
 #include <arm/physmem.h>
 #include <device.h>
+#include <lock.h>
+#include <slab.h>
+#include <ktimer.h>
+#include <crit.h>
+#include <section.h>
 
 extern void print_run_queue(void);
 
-int validate_all_tasks(task_t *tasks, size_t num_tasks)
+COLD int validate_all_tasks(task_t *tasks, size_t num_tasks)
 {
 	unsigned int i;
 	for(i = 0; i < num_tasks ; i++) {
@@ -57,12 +63,30 @@ int validate_all_tasks(task_t *tasks, size_t num_tasks)
 			printf("C > T for task %d is invalid\n", i);
 			return -1;
 		}
+
+		// validate the kernel stack size -- 0 picks the default
+		if(tasks[i].kstack_size != 0 
+		   && (tasks[i].kstack_size < OS_KSTACK_MIN 
+		       || tasks[i].kstack_size > OS_KSTACK_POOL)) {
+			printf("kstack_size for task %d is invalid\n", i);
+			return -1;
+		}
+
+		// validate the tracked part of the user stack
+		if(tasks[i].ustack_size != 0 
+		   && (tasks[i].ustack_size > (uintptr_t)tasks[i].stack_pos 
+		       || valid_addr((char *)tasks[i].stack_pos - tasks[i].ustack_size,
+		                     tasks[i].ustack_size, USR_START_ADDR, 
+		                     USR_END_ADDR) == 0)) {
+			printf("ustack_size for task %d is invalid\n", i);
+			return -1;
+		}
 	}
 	// all set!
 	return 0;
 }
 
-void swap_tasks(task_t *tasks, int i, int j)
+COLD void swap_tasks(task_t *tasks, int i, int j)
 {
 	task_t temp;
 	// do a deep copy of the entire struct
@@ -71,21 +95,27 @@ void swap_tasks(task_t *tasks, int i, int j)
 	temp.stack_pos = tasks[i].stack_pos;
 	temp.C = tasks[i].C;
 	temp.T = tasks[i].T;
+	temp.kstack_size = tasks[i].kstack_size;
+	temp.ustack_size = tasks[i].ustack_size;
 
 	tasks[i].lambda = tasks[j].lambda;
 	tasks[i].data = tasks[j].data;
 	tasks[i].stack_pos = tasks[j].stack_pos;
 	tasks[i].C = tasks[j].C;
 	tasks[i].T = tasks[j].T;
+	tasks[i].kstack_size = tasks[j].kstack_size;
+	tasks[i].ustack_size = tasks[j].ustack_size;
 
 	tasks[j].lambda = temp.lambda;
 	tasks[j].data = temp.data;
 	tasks[j].stack_pos = temp.stack_pos;
 	tasks[j].C = temp.C;
 	tasks[j].T = temp.T;
+	tasks[j].kstack_size = temp.kstack_size;
+	tasks[j].ustack_size = temp.ustack_size;
 }
 
-int sort_all_tasks(task_t *tasks, size_t num_tasks)
+COLD int sort_all_tasks(task_t *tasks, size_t num_tasks)
 {
 	unsigned int i, j;
 	for(i = 0; i < num_tasks; i++) {
@@ -111,9 +141,18 @@ int sort_all_tasks(task_t *tasks, size_t num_tasks)
 int task_create(task_t* tasks, size_t num_tasks)
 {
 	int ret;
-	unsigned int i = 0;
 	task_t idle_task;
-	disable_interrupts();
+	tcb_t *idle_tcb;
+	/*
+	 * the new set reuses the kernel stack pool from the bottom up, and a
+	 * task calling in would be running on it -- only code outside every
+	 * task may create one
+	 */
+	if(get_cur_tcb() != NULL) {
+		printf("task_create called from a running task\n");
+		return -EPERM;
+	}
+
 	/*
 	 * validate the tasks pointer and num_tasks
 	 */
@@ -143,7 +182,21 @@ int task_create(task_t* tasks, size_t num_tasks)
 	if(ret < 0) {
 		return -EINVAL;
 	}
-	
+
+	/*
+	 * make sure the new set fits before the old one is torn down
+	 */
+	if(sched_fits(tasks, num_tasks) < 0) {
+		printf("not enough tcbs or kernel stack for %lu tasks\n", num_tasks);
+		return -ENOMEM;
+	}
+
+	/*
+	 * set up the task set in one critical section, which the launch of the
+	 * first new task ends
+	 */
+	crit_enter();
+
 	/*
 	 * setup the run queues
 	 */
@@ -160,30 +213,41 @@ int task_create(task_t* tasks, size_t num_tasks)
 	mutex_init();
 
 	/*
-	 * allocate the tcb's for all tasks
+	 * drop the syscall rings, descriptor flags and pollers of any earlier
+	 * task set
 	 */
-	allocate_tasks(&tasks, num_tasks);
+	ring_init();
+	io_init();
+	poll_init();
+	ktimer_init();
+
+	/*
+	 * allocate the tcb's for all tasks and make them runnable -- sched_fits
+	 * said they fit, and the old set is already gone
+	 */
+	if(allocate_tasks(&tasks, num_tasks) < 0)
+		panic("task_create: tcbs ran out after sched_fits");
 	
 	/*
 	 * initialize the idle task
 	 */
-	sched_init(&idle_task);
+	idle_tcb = sched_init(&idle_task);
+	if(idle_tcb == NULL)
+		panic("task_create: no tcb left for the idle task");
 
-	for(i = 1; i <= num_tasks; i++) {
-		runqueue_add(&system_tcb[i], system_tcb[i].native_prio);
-	}
-	
 	print_run_queue();
+	stack_dump();
+	slab_dump();
 	/*
 	 * dispatch no save to launch the highest prio task 
 	 */
-	dispatch_init(&system_tcb[IDLE_PRIO]);
+	dispatch_init(idle_tcb);
 	dispatch_nosave();
 
     return 1; /* remove this line after adding your code */
 }
 
-int event_wait(unsigned int dev)
+HOT int event_wait(unsigned int dev)
 {
 	/*
 	 * validate the dev number
@@ -202,8 +266,61 @@ int event_wait(unsigned int dev)
 	return 0;
 }
 
+/**
+ * @brief Like event_wait, but gives up after millis milliseconds.
+ *
+ * @return 0 if the device signalled, -ETIMEDOUT if it did not in time,
+ *         -EINVAL for a bad device.
+ */
+int event_wait_timeout(unsigned int dev, unsigned long millis)
+{
+	if(dev >= NUM_DEVICES) {
+		return -EINVAL;
+	}
+	if(millis == 0) {
+		return -ETIMEDOUT;
+	}
+
+	return dev_wait_timeout(dev, ktimer_deadline(millis));
+}
+
+/**
+ * @brief Waits for any or all of a set of devices with a single sleep.
+ *
+ * @param mask  Bit (1 << dev) per device.
+ * @param mode  EVENT_ANY or EVENT_ALL.
+ *
+ * @return The devices in mask that signalled, -EINVAL for a bad argument.
+ */
+int event_wait_mask(unsigned long mask, int mode)
+{
+	if(mask == 0 || (mask >> NUM_DEVICES) != 0
+	   || (mode != EVENT_ANY && mode != EVENT_ALL)) {
+		return -EINVAL;
+	}
+
+	return dev_wait_mask(mask, mode == EVENT_ALL);
+}
+
+/**
+ * @brief Reports the peak kernel and user stack usage of up to count tasks.
+ *
+ * @return The number of entries filled in, -EFAULT for a bad buffer.
+ */
+int stack_usage(stack_usage_t* usage, size_t count)
+{
+	if(count > OS_MAX_TASKS) {
+		count = OS_MAX_TASKS;
+	}
+	if(count != 0 && valid_addr(usage, count * sizeof(stack_usage_t),
+	                            USR_START_ADDR, USR_END_ADDR) == 0) {
+		return -EFAULT;
+	}
+	return sched_stack_usage(usage, count);
+}
+
 /* An invalid syscall causes the kernel to exit. */
-void invalid_syscall(unsigned int call_num)
+COLD void invalid_syscall(unsigned int call_num)
 {
 	printf("Kernel panic: invalid syscall -- 0x%08x\n", call_num);
 
@@ -0,0 +1,162 @@
+/** @file ring.c
+ *
+ * @brief Batched syscalls through rings in task memory.
+ *
+ * A task registers one struct ring (bits/ring.h) and from then on queues
+ * operations by writing SQEs.  They run when the task calls ring_enter or,
+ * with RING_DRAIN_ON_BLOCK, a few at a time whenever the task is about to
+ * block in a syscall -- either way a whole batch costs at most one trap.
+ * SQEs always run in the task that queued them, with interrupts enabled and
+ * outside any critical section, like the syscalls they stand for.  Results
+ * come back as CQEs the task reads without trapping.
+ */
+
+#include <types.h>
+#include <config.h>
+#include <kernel.h>
+#include <syscall.h>
+#include <sched.h>
+#include <lock.h>
+#include <bits/errno.h>
+#include <bits/ring.h>
+
+/* A registered ring.  The array pointers and size are copied at
+ * registration so the task cannot redirect kernel writes later. */
+struct ring_reg
+{
+	struct ring*     ring;
+	struct ring_sqe* sqes;
+	struct ring_cqe* cqes;
+	unsigned long    entries;
+};
+
+/* Most SQEs a blocking syscall runs before it blocks */
+#define RING_BLOCK_BATCH  16
+
+/* The registered ring of each task, by native priority; boot code before the
+ * first task_create uses slot 0 */
+static struct ring_reg task_ring[OS_MAX_TASKS];
+
+/**
+ * @brief Forgets every registered ring -- called for a new task set.
+ */
+void ring_init(void)
+{
+	int i;
+
+	for(i = 0; i < OS_MAX_TASKS; i++)
+		task_ring[i].ring = NULL;
+}
+
+static long ring_op(const struct ring_sqe* sqe)
+{
+	switch(sqe->opcode) {
+		case RING_OP_NOP:
+			return 0;
+		case RING_OP_WRITE:
+			return write_syscall((int)sqe->arg0, (const void *)sqe->arg1,
+			                     (size_t)sqe->arg2);
+		case RING_OP_MUTEX_UNLOCK:
+			return mutex_unlock((int)sqe->arg0);
+		default:
+			return -EINVAL;
+	}
+}
+
+/*
+ * run up to max SQEs while there is room for their completions
+ * @return number of SQEs consumed, -EINVAL if the counters are corrupt
+ */
+static int ring_drain(struct ring_reg* reg, unsigned long max)
+{
+	struct ring *ring = reg->ring;
+	unsigned long mask = reg->entries - 1;
+	unsigned long sq_head = ring->sq_head, sq_tail = ring->sq_tail;
+	unsigned long cq_tail = ring->cq_tail;
+	struct ring_cqe *cqe;
+	struct ring_sqe *sqe;
+	unsigned long done = 0;
+
+	if(sq_tail - sq_head > reg->entries)
+		return -EINVAL;
+
+	while(sq_head != sq_tail && cq_tail - ring->cq_head < reg->entries
+	      && done < max) {
+		sqe = &reg->sqes[sq_head & mask];
+		cqe = &reg->cqes[cq_tail & mask];
+		cqe->user_data = sqe->user_data;
+		cqe->res = ring_op(sqe);
+		sq_head++;
+		cq_tail++;
+		done++;
+	}
+
+	/* the SQE slots are free once the CQEs are visible */
+	ring->cq_tail = cq_tail;
+	ring->sq_head = sq_head;
+	return done;
+}
+
+/**
+ * @brief Registers the calling task's ring, or unregisters it if ring is
+ * NULL.  Replaces any earlier registration.
+ *
+ * @return 0, or -EFAULT/-EINVAL if the ring or its arrays are bad.
+ */
+int ring_setup(struct ring* ring)
+{
+	uint8_t prio = get_cur_native_prio();
+	size_t n;
+
+	if(ring == NULL) {
+		task_ring[prio].ring = NULL;
+		return 0;
+	}
+
+	if(valid_addr(ring, sizeof(*ring), USR_START_ADDR, USR_END_ADDR) == 0)
+		return -EFAULT;
+
+	n = ring->entries;
+	if(n == 0 || n > RING_MAX_ENTRIES || (n & (n - 1)))
+		return -EINVAL;
+	if(valid_addr(ring->sqes, n * sizeof(struct ring_sqe), USR_START_ADDR,
+	              USR_END_ADDR) == 0
+	   || valid_addr(ring->cqes, n * sizeof(struct ring_cqe), USR_START_ADDR,
+	                 USR_END_ADDR) == 0)
+		return -EFAULT;
+
+	task_ring[prio].sqes = ring->sqes;
+	task_ring[prio].cqes = ring->cqes;
+	task_ring[prio].entries = n;
+	task_ring[prio].ring = ring;
+	return 0;
+}
+
+/**
+ * @brief Runs every queued SQE of the calling task that has room for its
+ * completion.
+ *
+ * @return The number of SQEs consumed, or -ENXIO if no ring is registered.
+ */
+int ring_enter(void)
+{
+	struct ring_reg *reg = &task_ring[get_cur_native_prio()];
+
+	if(reg->ring == NULL)
+		return -ENXIO;
+	return ring_drain(reg, reg->entries);
+}
+
+/**
+ * @brief Runs up to RING_BLOCK_BATCH SQEs of the calling task, if its ring
+ * asked to be drained when it blocks.  Called by blocking syscalls before
+ * they enter the section they sleep in.
+ */
+void ring_block(void)
+{
+	struct ring_reg *reg = &task_ring[get_cur_native_prio()];
+
+	if(reg->ring != NULL && (reg->ring->flags & RING_DRAIN_ON_BLOCK)
+	   && reg->ring->sq_head != reg->ring->sq_tail)
+		ring_drain(reg, RING_BLOCK_BATCH);
+}
@@ -12,13 +12,14 @@
 #include <arm/timer.h>
 #include <syscall.h>
 #include <exports.h>
+#include <section.h>
 
 /*
  * implementation of the time syscall
  * @param: void 
  * @return unsigned long - time in milliseconds since bootup 
  */
-unsigned long time_syscall(void)
+HOT unsigned long time_syscall(void)
 {
  	return (get_millis());
 }
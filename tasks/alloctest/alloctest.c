@@ -0,0 +1,259 @@
+/** @file alloctest.c
+ *
+ * @brief Fuzzes the TLSF heap and checks the arena's marks and high water.
+ *
+ * Random allocations, frees and resizes run against a table of live blocks.
+ * Each block is filled with a pattern of its own, so an allocation that
+ * overlaps another shows up as a corrupted pattern when either is freed.
+ * Every so often the whole heap is emptied, and it must then coalesce back
+ * into the single free block heap_init made.  The libc has no realloc, so a
+ * resize is what realloc would do over the heap: allocate, copy, free.
+ *
+ * Builds as a task package and, through `make alloctest-host', as a native
+ * program.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <heap.h>
+#include <arena.h>
+
+#define NUM_CASES   200000
+#define NUM_SLOTS   64
+#define MAX_SIZE    1024
+#define EMPTY_EVERY 5000
+#define HEAP_SIZE   (128 * 1024)
+#define ARENA_SIZE  4096
+#define MAX_REPORT  10
+
+#ifdef ALLOCTEST_HOST
+/* Natively there is no event_wait wrapper to own the hook arena.c sets. */
+void (*event_wait_hook)(unsigned int dev);
+#endif
+
+struct slot
+{
+	unsigned char *p;
+	size_t size;
+	unsigned char fill;
+};
+
+static unsigned long heap_mem[HEAP_SIZE / sizeof(unsigned long)];
+static unsigned long arena_mem[ARENA_SIZE / sizeof(unsigned long)];
+static struct slot slots[NUM_SLOTS];
+static heap_t *heap;
+static heap_stats_t fresh;
+static int failures;
+
+static void fail(int n, const char *what, long got, long want)
+{
+	if (failures++ < MAX_REPORT)
+		printf("case %d: %s: got %ld, want %ld\n", n, what, got, want);
+}
+
+static int pattern_ok(const struct slot *s)
+{
+	size_t i;
+
+	for (i = 0; i < s->size; i++)
+		if (s->p[i] != (unsigned char)(s->fill + i))
+			return 0;
+	return 1;
+}
+
+static void fill(struct slot *s, size_t from)
+{
+	size_t i;
+
+	for (i = from; i < s->size; i++)
+		s->p[i] = (unsigned char)(s->fill + i);
+}
+
+/* Checks that a new block is aligned and inside the region. */
+static void check_block(int n, const unsigned char *p, size_t size)
+{
+	const unsigned char *lo = (const unsigned char *)heap_mem;
+
+	if ((unsigned long)p & 7)
+		fail(n, "alignment", (unsigned long)p & 7, 0);
+	if (p < lo || p + size > lo + sizeof(heap_mem))
+		fail(n, "block outside heap", (long)(p - lo), 0);
+}
+
+static void release(int n, struct slot *s)
+{
+	if (!pattern_ok(s))
+		fail(n, "pattern", 0, 1);
+	heap_free(heap, s->p);
+	s->p = 0;
+}
+
+static void resize(int n, struct slot *s, size_t size)
+{
+	unsigned char *p = heap_alloc(heap, size);
+	size_t keep = size < s->size ? size : s->size;
+
+	if (!p)
+		return;
+	check_block(n, p, size);
+	memcpy(p, s->p, keep);
+	if (!pattern_ok(s))
+		fail(n, "pattern before resize", 0, 1);
+	heap_free(heap, s->p);
+	s->p = p;
+	s->size = size;
+	fill(s, keep);
+}
+
+/* Frees everything; the heap must be one free block again. */
+static void empty_heap(int n)
+{
+	heap_stats_t st;
+	int i;
+
+	for (i = 0; i < NUM_SLOTS; i++)
+		if (slots[i].p)
+			release(n, &slots[i]);
+
+	heap_stats(heap, &st);
+	if (st.used != 0)
+		fail(n, "used after emptying", st.used, 0);
+	if (st.free_blocks != 1)
+		fail(n, "free blocks after emptying", st.free_blocks, 1);
+	if (st.largest_free != fresh.largest_free)
+		fail(n, "largest free after emptying", st.largest_free,
+		     fresh.largest_free);
+}
+
+static void test_heap(void)
+{
+	struct slot *s;
+	size_t size;
+	int n;
+
+	heap = heap_init(heap_mem, sizeof(heap_mem));
+	if (!heap)
+	{
+		fail(0, "heap_init", 0, 1);
+		return;
+	}
+	heap_stats(heap, &fresh);
+	if (fresh.free_blocks != 1 || fresh.used != 0)
+		fail(0, "fresh heap free blocks", fresh.free_blocks, 1);
+
+	if (heap_alloc(heap, 0))
+		fail(0, "heap_alloc(0)", 1, 0);
+	heap_free(heap, 0);
+
+	for (n = 0; n < NUM_CASES; n++)
+	{
+		s = &slots[rand() % NUM_SLOTS];
+		/* Mostly small blocks, now and then one from the big lists. */
+		size = (rand() % 8) ? (size_t)(rand() % 64 + 1)
+		                    : (size_t)(rand() % MAX_SIZE + 1);
+
+		if (!s->p)
+		{
+			s->p = heap_alloc(heap, size);
+			if (!s->p)
+				continue;
+			check_block(n, s->p, size);
+			s->size = size;
+			s->fill = (unsigned char)rand();
+			fill(s, 0);
+		}
+		else if (rand() % 3)
+			release(n, s);
+		else
+			resize(n, s, size);
+
+		if (n % EMPTY_EVERY == EMPTY_EVERY - 1)
+			empty_heap(n);
+	}
+	empty_heap(n);
+
+	/* With everything coalesced, the largest free block is one request. */
+	s = &slots[0];
+	s->p = heap_alloc(heap, fresh.largest_free);
+	if (!s->p)
+		fail(n, "whole heap in one block", 0, 1);
+	else
+	{
+		s->size = fresh.largest_free;
+		s->fill = 0;
+		fill(s, 0);
+		release(n, s);
+	}
+}
+
+static void test_arena(void)
+{
+	arena_t arena;
+	arena_mark_t outer, inner;
+	char *a, *b, *c, *d;
+
+	if (arena_init(&arena, arena_mem, sizeof(arena_mem)) != 0)
+	{
+		fail(0, "arena_init", -1, 0);
+		return;
+	}
+
+	a = arena_alloc(&arena, 10);
+	outer = arena_mark(&arena);
+	b = arena_alloc(&arena, 100);
+	inner = arena_mark(&arena);
+	c = arena_alloc(&arena, 200);
+	if (!a || !b || !c)
+		fail(0, "arena_alloc", 0, 1);
+	if (b != a + 16 || c != b + 104)
+		fail(0, "arena layout", (long)(c - a), 120);
+
+	/* Releasing the inner mark keeps what the outer one covers. */
+	arena_release(&arena, inner);
+	d = arena_alloc(&arena, 8);
+	if (d != c)
+		fail(0, "reuse after inner release", (long)(d - a), (long)(c - a));
+	if (arena.high_water != 320)
+		fail(0, "high water after inner release", arena.high_water, 320);
+
+	/* The outer release drops the inner allocations with it. */
+	arena_release(&arena, outer);
+	d = arena_alloc(&arena, 1);
+	if (d != b)
+		fail(0, "reuse after outer release", (long)(d - a), (long)(b - a));
+
+	d = arena_alloc_aligned(&arena, 16, 64);
+	if (!d || ((unsigned long)d & 63))
+		fail(0, "arena_alloc_aligned", (unsigned long)d & 63, 0);
+
+	arena_reset(&arena);
+	if (arena_alloc(&arena, 1) != a)
+		fail(0, "reuse after reset", 0, 1);
+	if (arena.high_water != 320)
+		fail(0, "high water after reset", arena.high_water, 320);
+
+	/* Exhaustion fails cleanly and does not move the top. */
+	arena_reset(&arena);
+	if (arena_alloc(&arena, sizeof(arena_mem) + 1))
+		fail(0, "oversized arena_alloc", 1, 0);
+	if (!arena_alloc(&arena, sizeof(arena_mem)))
+		fail(0, "whole arena", 0, 1);
+	if (arena_alloc(&arena, 1))
+		fail(0, "alloc from full arena", 1, 0);
+	arena_reset(&arena);
+	if (arena.high_water != sizeof(arena_mem))
+		fail(0, "high water when full", arena.high_water, sizeof(arena_mem));
+}
+
+int main(int argc, char** argv)
+{
+	srand(349);
+	test_heap();
+	test_arena();
+
+	printf("alloctest: %d cases, %d failures\n", NUM_CASES, failures);
+
+	argc=argc; /* remove compiler warning */
+	argv[0]=argv[0]; /* remove compiler warning */
+	return failures != 0;
+}
@@ -0,0 +1,24 @@
+PROGS_ALLOCTEST_OBJS := alloctest.o
+PROGS_ALLOCTEST_OBJS := $(PROGS_ALLOCTEST_OBJS:%=$(TDIR)/alloctest/%)
+ALL_OBJS += $(PROGS_ALLOCTEST_OBJS)
+
+$(TDIR)/bin/alloctest : $(TSTART) $(PROGS_ALLOCTEST_OBJS) $(TLIBC)
+
+# The same harness links natively against the heap and arena sources so the
+# allocators can be fuzzed on the development machine:  make alloctest-host
+ALLOCTEST_HOST := $(TDIR)/bin/alloctest-host
+ALLOCTEST_HOST_SRCS := $(TDIR)/alloctest/alloctest.c \
+	$(TLIBCDIR)/stdlib/tlsf.c $(TLIBCDIR)/stdlib/arena.c
+ALL_CLOBBERS += $(ALLOCTEST_HOST)
+
+.PHONY: alloctest-host
+alloctest-host: $(ALLOCTEST_HOST)
+	@echo RUN $(notdir $<)
+	@$<
+
+$(ALLOCTEST_HOST): $(ALLOCTEST_HOST_SRCS) $(TLIBCDIR)/include/heap.h \
+		$(TLIBCDIR)/include/arena.h
+	@echo HOSTCC $(notdir $@)
+	@mkdir -p $(dir $@)
+	@$(HOSTCC) $(HOSTCFLAGS) -DALLOCTEST_HOST -I$(TLIBCDIR)/include -o $@ \
+		$(ALLOCTEST_HOST_SRCS)
@@ -69,21 +69,29 @@ int main(int argc, char** argv)
 	tasks[0].stack_pos = (void*)0xa2000000;
 	tasks[0].C = 1;
 	tasks[0].T = PERIOD_DEV0;
+	tasks[0].kstack_size = 0;
+	tasks[0].ustack_size = 4096;
 	tasks[1].lambda = fun2;
 	tasks[1].data = (void*)'#';
 	tasks[1].stack_pos = (void*)0xa1000000;
 	tasks[1].C = 1;
 	tasks[1].T = PERIOD_DEV1;
+	tasks[1].kstack_size = 0;
+	tasks[1].ustack_size = 4096;
 	tasks[2].lambda = fun3;
 	tasks[2].data = (void*)'*';
 	tasks[2].stack_pos = (void*)0xa1800000;
 	tasks[2].C = 1;
 	tasks[2].T = PERIOD_DEV2;
+	tasks[2].kstack_size = 0;
+	tasks[2].ustack_size = 4096;
 	tasks[3].lambda = fun4;
 	tasks[3].data = (void*)'%';
 	tasks[3].stack_pos = (void*)0xa1c00000;
 	tasks[3].C = 1;
 	tasks[3].T = PERIOD_DEV3;
+	tasks[3].kstack_size = 0;
+	tasks[3].ustack_size = 4096;
 
 	task_create(tasks, 4);
 	argc=argc; /* remove compiler warning */
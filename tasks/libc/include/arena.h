@@ -0,0 +1,85 @@
+/** @file arena.h
+ *
+ * @brief Declares the bump-pointer arena for per-job scratch memory.
+ *
+ * An arena hands out memory by advancing a pointer through a caller-supplied
+ * region and never frees individual objects.  Everything allocated since a
+ * mark is dropped at once with arena_release, and arena_reset drops it all.
+ * A periodic task typically attaches its arena to the device it waits on, so
+ * the scratch data of one job is gone by the time the next job starts.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <sys/types.h>
+#include <inline.h>
+
+/* Every allocation starts on this boundary unless asked for more */
+#define ARENA_ALIGN 8
+
+typedef struct arena
+{
+	char*         base;        /**< Start of the region, ARENA_ALIGN aligned */
+	char*         top;         /**< Next free byte, ARENA_ALIGN aligned */
+	char*         end;         /**< One past the last usable byte */
+	size_t        high_water;  /**< Most bytes ever in use at a release */
+	unsigned int  dev;         /**< Device whose event_wait resets us */
+	struct arena* next;        /**< Next attached arena */
+} arena_t;
+
+/* A saved allocation point; only meaningful to the arena it came from */
+typedef char* arena_mark_t;
+
+int arena_init(arena_t* arena, void* mem, size_t bytes) __attribute__((nonnull));
+void* arena_alloc_aligned(arena_t* arena, size_t size, size_t align)
+	__attribute__((nonnull, malloc));
+void arena_attach(arena_t* arena, unsigned int dev) __attribute__((nonnull));
+void arena_detach(arena_t* arena) __attribute__((nonnull));
+
+/**
+ * @brief Allocates size bytes aligned to ARENA_ALIGN.
+ *
+ * @return The memory, or 0 if the arena is exhausted.
+ */
+INLINE void* __attribute__((nonnull, malloc)) arena_alloc(arena_t* arena,
+	size_t size)
+{
+	char* p = arena->top;
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	if (size > (size_t)(arena->end - p))
+		return 0;
+	arena->top = p + size;
+	return p;
+}
+
+/**
+ * @brief Remembers the current allocation point.  Marks nest.
+ */
+INLINE arena_mark_t __attribute__((nonnull)) arena_mark(arena_t* arena)
+{
+	return arena->top;
+}
+
+/**
+ * @brief Frees everything allocated since mark was taken, including the
+ * allocations of any marks nested inside it.
+ */
+INLINE void __attribute__((nonnull)) arena_release(arena_t* arena,
+	arena_mark_t mark)
+{
+	if ((size_t)(arena->top - arena->base) > arena->high_water)
+		arena->high_water = arena->top - arena->base;
+	arena->top = mark;
+}
+
+/**
+ * @brief Frees everything in the arena.
+ */
+INLINE void __attribute__((nonnull)) arena_reset(arena_t* arena)
+{
+	arena_release(arena, arena->base);
+}
+
+#endif /* ARENA_H */
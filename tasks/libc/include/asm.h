@@ -27,7 +27,9 @@
 #define DATASYM(x)   .type    x,%object
 #define SIZE(x,s)    .size    x, s
 
-#define FUNC(x)      .text ; ALIGN ; FUNCSYM(x) ; GLOBAL(x)
+/* Hand-written routines are ARM code, and return with bx so that Thumb
+ * callers work too (TASK_THUMB) */
+#define FUNC(x)      .text ; .arm ; ALIGN ; FUNCSYM(x) ; GLOBAL(x)
 #define	DATA(x,s)    .data ; ALIGN ; DATASYM(x) ; SIZE(x,s) ; GLOBAL(x)
 
 
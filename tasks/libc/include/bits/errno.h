@@ -38,6 +38,7 @@
 #define EDOM          33    /* Math argument out of domain of func */
 #define ERANGE        34    /* Math result not representable */
 #define EDEADLOCK     58    /* File locking deadlock error */
+#define ETIMEDOUT    110    /* Connection timed out */
 
 #define ESCHED       100    /* Unable to schedule */
 
@@ -0,0 +1,27 @@
+/** @file poll.h
+ *
+ * @brief Defines the descriptor array and events of the poll syscall
+ */
+
+#ifndef BITS_POLL_H
+#define BITS_POLL_H
+
+#define POLLIN    0x001   /**< Input is ready, or the device fired */
+#define POLLOUT   0x004   /**< Output will not block */
+#define POLLNVAL  0x020   /**< Not a descriptor poll knows */
+
+/* Most descriptors poll accepts in one call */
+#define POLL_MAX  16
+
+#ifndef ASSEMBLER
+
+struct pollfd
+{
+	int   fd;       /**< STDIN_FILENO, STDOUT_FILENO or DEV_FILENO(dev) */
+	short events;   /**< Events to wait for */
+	short revents;  /**< Events that are ready */
+};
+
+#endif /* ASSEMBLER */
+
+#endif /* BITS_POLL_H */
@@ -0,0 +1,57 @@
+/** @file ring.h
+ *
+ * @brief Layout of the submission and completion rings a task shares with
+ *        the kernel.
+ *
+ * The task owns the memory.  It fills submission entries (SQEs) and bumps
+ * sq_tail; the kernel consumes them from sq_head and posts one completion
+ * entry (CQE) per SQE at cq_tail; the task reaps completions from cq_head.
+ * All four counters run freely and are masked with entries - 1, so each
+ * side only ever writes its own two counters.
+ */
+
+#ifndef BITS_RING_H
+#define BITS_RING_H
+
+/* Operations */
+#define RING_OP_NOP           0   /**< Completes with 0 */
+#define RING_OP_WRITE         1   /**< write(arg0, arg1, arg2) */
+#define RING_OP_MUTEX_UNLOCK  2   /**< mutex_unlock(arg0) */
+
+/* Ring flags */
+#define RING_DRAIN_ON_BLOCK     0x1  /**< Drain whenever the task blocks */
+
+#define RING_MAX_ENTRIES      256
+
+#ifndef ASSEMBLER
+
+struct ring_sqe
+{
+	unsigned long opcode;     /**< RING_OP_* */
+	unsigned long arg0;
+	unsigned long arg1;
+	unsigned long arg2;
+	unsigned long user_data;  /**< Copied to the completion untouched */
+};
+
+struct ring_cqe
+{
+	unsigned long user_data;  /**< From the SQE */
+	long          res;        /**< What the syscall would have returned */
+};
+
+struct ring
+{
+	volatile unsigned long sq_head;  /**< Next SQE the kernel consumes */
+	volatile unsigned long sq_tail;  /**< One past the last submitted SQE */
+	volatile unsigned long cq_head;  /**< Next CQE the task reaps */
+	volatile unsigned long cq_tail;  /**< One past the last posted CQE */
+	unsigned long    entries;        /**< Slots in each ring, a power of two */
+	unsigned long    flags;          /**< RING_* flags */
+	struct ring_sqe* sqes;           /**< entries submission slots */
+	struct ring_cqe* cqes;           /**< entries completion slots */
+};
+
+#endif /* ASSEMBLER */
+
+#endif /* BITS_RING_H */
@@ -16,17 +16,30 @@
 
 #define READ_SWI  (SWI_BASE + 3)
 #define WRITE_SWI (SWI_BASE + 4)
+#define READV_SWI  (SWI_BASE + 145)
+#define WRITEV_SWI (SWI_BASE + 146)
+#define FCNTL_SWI  (SWI_BASE + 55)
+#define POLL_SWI   (SWI_BASE + 168)
 
 /* The following are not linux compatible */
 #define TIME_SWI  (SWI_BASE + 6)
 #define SLEEP_SWI (SWI_BASE + 7)
+#define READ_TIMEOUT_SWI (SWI_BASE + 8)
 
 #define CREATE_SWI    (SWI_BASE + 10)
 
 #define MUTEX_CREATE  (SWI_BASE + 15)
 #define MUTEX_LOCK    (SWI_BASE + 16)
 #define MUTEX_UNLOCK  (SWI_BASE + 17)
+#define MUTEX_LOCK_TIMEOUT (SWI_BASE + 18)
 
 #define EVENT_WAIT    (SWI_BASE + 20)
+#define EVENT_WAIT_MASK (SWI_BASE + 21)
+#define EVENT_WAIT_TIMEOUT (SWI_BASE + 22)
+
+#define STACK_USAGE   (SWI_BASE + 25)
+
+#define RING_SETUP    (SWI_BASE + 26)
+#define RING_ENTER    (SWI_BASE + 27)
 
 #endif /* BITS_SWI_H */
@@ -0,0 +1,47 @@
+/** @file time_page.h
+ *
+ * @brief Layout of the time page the kernel shares with tasks.
+ *
+ * The kernel rewrites the page on every timer tick; tasks only read it, and
+ * with OS_MMU set the MMU makes the page read-only to user mode.  seq is a
+ * sequence lock: it is odd while an update is in progress, so a reader copies
+ * what it needs, re-reads seq and retries if it changed or was odd.  Sub-tick
+ * time comes from reading the OS timer count register at oscr_addr directly,
+ * which user mode may do since the peripheral window is mapped for it.  The
+ * per-second fields and the reciprocals let readers build any clock format
+ * with multiplies and shifts only.
+ */
+
+#ifndef BITS_TIME_PAGE_H
+#define BITS_TIME_PAGE_H
+
+/* The page is the top page of user memory; the user stack starts below it */
+#define TIME_PAGE_ADDR  0xa2fff000
+
+#ifndef ASSEMBLER
+
+struct time_page
+{
+	volatile unsigned long seq;      /**< Odd while the kernel is writing */
+	volatile unsigned long ticks;    /**< Timer ticks since boot, low word */
+	volatile unsigned long ticks_hi; /**< Timer ticks since boot, high word */
+	volatile unsigned long sec;      /**< Whole seconds since boot */
+	volatile unsigned long sec_ticks; /**< Ticks since sec last changed */
+	unsigned long ms_per_tick;       /**< Milliseconds per tick */
+	unsigned long us_per_tick;       /**< Microseconds per tick */
+	unsigned long ns_per_tick;       /**< Nanoseconds per tick */
+	unsigned long oscr_addr;         /**< Address of the OS timer count register */
+	unsigned long oscr_hz;           /**< OS timer count rate */
+	unsigned long oscr_per_tick;     /**< Count at which a tick fires; OSCR restarts at 0 */
+	unsigned long oscr_us_mult;      /**< us = (count * oscr_us_mult) >> 32 */
+	unsigned long oscr_ns_mult;      /**< ns = (count * oscr_ns_mult) >> 16 */
+	volatile unsigned long irq_off_max_ns; /**< Longest masked stretch of the interrupt path */
+	volatile unsigned long crit_max_ns;    /**< Longest kernel critical section, if traced */
+	volatile unsigned long crit_max_site;  /**< Kernel address that section was entered from */
+};
+
+#define TIME_PAGE  ((const struct time_page*)TIME_PAGE_ADDR)
+
+#endif /* ASSEMBLER */
+
+#endif /* BITS_TIME_PAGE_H */
@@ -0,0 +1,22 @@
+/** @file uio.h
+ *
+ * @brief Defines the segment descriptor of the scatter-gather syscalls
+ */
+
+#ifndef BITS_UIO_H
+#define BITS_UIO_H
+
+/* Most segments readv or writev accept in one call */
+#define IOV_MAX 16
+
+#ifndef ASSEMBLER
+
+struct iovec
+{
+	void*         iov_base;  /**< Start of the segment */
+	unsigned long iov_len;   /**< Bytes in the segment */
+};
+
+#endif /* ASSEMBLER */
+
+#endif /* BITS_UIO_H */
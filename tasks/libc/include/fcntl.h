@@ -0,0 +1,13 @@
+/** @file fcntl.h
+ *
+ * @brief Declares fcntl, which reads and sets descriptor flags
+ */
+
+#ifndef FCNTL_H
+#define FCNTL_H
+
+#include <bits/fcntl.h>
+
+int fcntl(int fd, int cmd, ...);
+
+#endif /* FCNTL_H */
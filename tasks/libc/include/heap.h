@@ -0,0 +1,39 @@
+/** @file heap.h
+ *
+ * @brief Declares the Two-Level Segregated Fit heap.
+ *
+ * A heap manages one caller-supplied region.  heap_alloc and heap_free run in
+ * constant time regardless of how many blocks exist: free blocks are kept in
+ * size-class lists indexed by a two-level bitmap, and the right list is found
+ * with a pair of count-leading-zero operations.  Only heap_stats walks the
+ * free lists.
+ */
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <sys/types.h>
+
+typedef struct heap heap_t;
+
+struct heap_stats
+{
+	size_t       size;          /**< Bytes managed, block headers included */
+	size_t       used;          /**< Bytes in allocated blocks, headers included */
+	size_t       high_water;    /**< Largest value of used since heap_init */
+	size_t       free;          /**< Bytes available for allocation */
+	size_t       largest_free;  /**< Payload bytes of the largest free block */
+	unsigned int free_blocks;   /**< Number of free blocks */
+	unsigned int fragmentation; /**< Percent of free bytes outside the largest block */
+};
+typedef struct heap_stats heap_stats_t;
+
+heap_t* heap_init(void* mem, size_t bytes) __attribute__((nonnull));
+void* heap_alloc(heap_t* heap, size_t size) __attribute__((nonnull));
+void heap_free(heap_t* heap, void* ptr) __attribute__((nonnull (1)));
+void heap_stats(heap_t* heap, heap_stats_t* stats) __attribute__((nonnull));
+
+/* The heap behind malloc and free, or 0 before malloc_init */
+heap_t* malloc_get_heap(void);
+
+#endif /* HEAP_H */
@@ -0,0 +1,14 @@
+/** @file poll.h
+ *
+ * @brief Declares poll, which waits on the console and devices at once
+ */
+
+#ifndef POLL_H
+#define POLL_H
+
+#include <bits/fileno.h>
+#include <bits/poll.h>
+
+int poll(struct pollfd *fds, unsigned long nfds, int timeout);
+
+#endif /* POLL_H */
@@ -0,0 +1,103 @@
+/** @file ring.h
+ *
+ * @brief Declares helpers for batching syscalls through a ring.
+ *
+ * A task queues operations with ring_get_sqe and the ring_prep_* calls and
+ * hands the whole batch to the kernel with one ring_submit.  A ring set up
+ * with RING_DRAIN_ON_BLOCK needs no trap of its own: the kernel drains part
+ * of it whenever the task blocks -- in event_wait, mutex_lock, poll and the
+ * like -- so ring_flush alone publishes the batch to a task that blocks
+ * often.  Completions are reaped with ring_peek_cqe and ring_cqe_seen,
+ * which only read memory.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include <sys/types.h>
+#include <bits/ring.h>
+#include <inline.h>
+
+int ring_init(struct ring* ring, struct ring_sqe* sqes, struct ring_cqe* cqes,
+	unsigned long entries, unsigned long flags) __attribute__((nonnull));
+int ring_setup(struct ring* ring);
+int ring_enter(void);
+
+/**
+ * @brief Claims the next free submission slot.
+ *
+ * @return The slot, or 0 if the submission ring is full.
+ */
+INLINE struct ring_sqe* __attribute__((nonnull)) ring_get_sqe(struct ring* ring)
+{
+	if (ring->sq_tail - ring->sq_head >= ring->entries)
+		return 0;
+	return &ring->sqes[ring->sq_tail & (ring->entries - 1)];
+}
+
+/**
+ * @brief Publishes the slot taken by the last ring_get_sqe.
+ */
+INLINE void __attribute__((nonnull)) ring_flush(struct ring* ring)
+{
+	/* the kernel may drain at the next block -- fill the SQE first */
+	__asm__ volatile("" ::: "memory");
+	ring->sq_tail = ring->sq_tail + 1;
+}
+
+/**
+ * @brief Fills an SQE for write(fd, buf, count).
+ */
+INLINE void __attribute__((nonnull)) ring_prep_write(struct ring_sqe* sqe,
+	int fd, const void* buf, size_t count, unsigned long user_data)
+{
+	sqe->opcode = RING_OP_WRITE;
+	sqe->arg0 = fd;
+	sqe->arg1 = (unsigned long)buf;
+	sqe->arg2 = count;
+	sqe->user_data = user_data;
+}
+
+/**
+ * @brief Fills an SQE for mutex_unlock(mutex).
+ */
+INLINE void __attribute__((nonnull)) ring_prep_mutex_unlock(
+	struct ring_sqe* sqe, int mutex, unsigned long user_data)
+{
+	sqe->opcode = RING_OP_MUTEX_UNLOCK;
+	sqe->arg0 = mutex;
+	sqe->user_data = user_data;
+}
+
+/**
+ * @brief Traps once to run everything published so far.
+ *
+ * @return The number of SQEs the kernel consumed, or -1 with errno set.
+ */
+INLINE int __attribute__((nonnull)) ring_submit(struct ring* ring)
+{
+	return ring_enter();
+}
+
+/**
+ * @brief Looks at the oldest unreaped completion.
+ *
+ * @return The completion, or 0 if there is none.
+ */
+INLINE struct ring_cqe* __attribute__((nonnull)) ring_peek_cqe(
+	struct ring* ring)
+{
+	if (ring->cq_head == ring->cq_tail)
+		return 0;
+	return &ring->cqes[ring->cq_head & (ring->entries - 1)];
+}
+
+/**
+ * @brief Hands the completion returned by ring_peek_cqe back to the kernel.
+ */
+INLINE void __attribute__((nonnull)) ring_cqe_seen(struct ring* ring)
+{
+	ring->cq_head = ring->cq_head + 1;
+}
+
+#endif /* RING_H */
@@ -13,6 +13,8 @@
 #ifndef STDLIB_H
 #define STDLIB_H
 
+#include <sys/types.h>
+
 long atol(const char* str) __attribute__((const, nonnull));
 int atoi(const char* str) __attribute__((const, nonnull));
 
@@ -22,4 +24,9 @@ unsigned long strtoul(const char* p, char** out_p, int base) __attribute__((cons
 int rand(void);
 void srand(unsigned int seed);
 
+/* Dynamic memory -- see heap.h for the underlying allocator */
+int malloc_init(void* mem, size_t bytes) __attribute__((nonnull));
+void* malloc(size_t size) __attribute__((malloc));
+void free(void* ptr);
+
 #endif /* STDLIB_H */
@@ -0,0 +1,15 @@
+/** @file uio.h
+ *
+ * @brief Declares the scatter-gather I/O calls
+ */
+
+#ifndef SYS_UIO_H
+#define SYS_UIO_H
+
+#include <sys/types.h>
+#include <bits/uio.h>
+
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt);
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+
+#endif /* SYS_UIO_H */
@@ -24,11 +24,28 @@ struct task
 	void*         stack_pos;   /**< The starting position of the task's sp */
 	unsigned long C;           /**< The worst-case computation time */
 	unsigned long T;           /**< The task's period */
+	unsigned long kstack_size; /**< Kernel stack bytes, 0 for the default */
+	unsigned long ustack_size; /**< Bytes below stack_pos to paint and track, 0 for none */
 };
 typedef struct task task_t;
 
+/**
+ * Peak stack usage of one task.  A peak that reaches the size means the
+ * stack -- or the tracked part of it -- was exhausted.
+ */
+struct stack_usage
+{
+	unsigned long prio;        /**< The task's native priority */
+	unsigned long kstack_size; /**< Kernel stack bytes */
+	unsigned long kstack_peak; /**< Most kernel stack bytes ever used */
+	unsigned long ustack_size; /**< Tracked user stack bytes, 0 if untracked */
+	unsigned long ustack_peak; /**< Most tracked user stack bytes ever used */
+};
+typedef struct stack_usage stack_usage_t;
+
 
 int task_create(task_t* tasks, size_t num_tasks);
+int stack_usage(stack_usage_t* usage, size_t count);
 
 
 #endif /* TASK_H */
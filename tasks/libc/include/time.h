@@ -0,0 +1,30 @@
+/** @file time.h
+ *
+ * @brief Declares the monotonic clock.
+ *
+ * The clock combines the kernel's 64-bit tick count with the live OS timer
+ * count, so it resolves 271 ns and never wraps in practice.  Reading it is
+ * a few loads from the time page -- no syscall and no division.
+ */
+
+#ifndef TIME_H
+#define TIME_H
+
+#include <sys/types.h>
+
+typedef long          time_t;
+typedef int           clockid_t;
+
+#define CLOCK_MONOTONIC  1
+
+struct timespec
+{
+	time_t tv_sec;   /**< Whole seconds */
+	long   tv_nsec;  /**< Nanoseconds, 0 to 999999999 */
+};
+
+int clock_gettime(clockid_t clock, struct timespec* ts) __attribute__((nonnull));
+uint64_t clock_ns(void);
+uint64_t clock_us(void);
+
+#endif /* TIME_H */
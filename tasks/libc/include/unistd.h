@@ -18,10 +18,26 @@
 #define PERIOD_DEV2 500
 #define PERIOD_DEV3 50
 
+/* event_wait_mask modes */
+#define EVENT_ANY   0   /* Wake when any device in the mask signals */
+#define EVENT_ALL   1   /* Wake once every device in the mask has */
+
 ssize_t read(int fd, void *buf, size_t count);
+ssize_t read_timeout(int fd, void *buf, size_t count, unsigned long millis);
 ssize_t write(int fd, const void *buf, size_t count);
 unsigned long time(void);
+unsigned long time_us(void);
 void sleep(unsigned long millis);
 int event_wait(unsigned int dev);
+int event_wait_mask(unsigned long mask, int mode);
+int event_wait_timeout(unsigned int dev, unsigned long millis);
+
+int mutex_create(void);
+int mutex_lock(int mutex);
+int mutex_lock_timeout(int mutex, unsigned long millis);
+int mutex_unlock(int mutex);
+
+/* Called with the device after every successful event_wait, if set */
+extern void (*event_wait_hook)(unsigned int dev);
 
 #endif /* UNISTD_H */
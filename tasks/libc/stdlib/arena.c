@@ -0,0 +1,97 @@
+/** @file arena.c
+ *
+ * @brief Bump-pointer arenas and the event_wait auto-reset hook.
+ *
+ * The allocation fast path lives in arena.h; this file holds the library
+ * copies of the inline functions plus the calls that are not worth inlining.
+ */
+
+#define IMPLEMENTATION
+#include <arena.h>
+#include <unistd.h>
+
+/* Arenas reset on return from event_wait, in attach order */
+static arena_t* attached;
+
+/**
+ * @brief Places an empty arena over the region [mem, mem + bytes).
+ *
+ * @return 0 on success, -1 if the region cannot hold a single allocation.
+ */
+int arena_init(arena_t* arena, void* mem, size_t bytes)
+{
+	size_t skew = -(uintptr_t)mem & (ARENA_ALIGN - 1);
+
+	if (bytes < skew + ARENA_ALIGN)
+		return -1;
+
+	arena->base = (char*)mem + skew;
+	arena->top = arena->base;
+	arena->end = arena->base + ((bytes - skew) & ~(size_t)(ARENA_ALIGN - 1));
+	arena->high_water = 0;
+	arena->dev = 0;
+	arena->next = 0;
+	return 0;
+}
+
+/**
+ * @brief Allocates size bytes aligned to align, which must be a power of two.
+ *
+ * The padding in front of the block is lost until the next release or reset.
+ *
+ * @return The memory, or 0 if the arena is exhausted.
+ */
+void* arena_alloc_aligned(arena_t* arena, size_t size, size_t align)
+{
+	size_t pad;
+
+	if (align <= ARENA_ALIGN)
+		return arena_alloc(arena, size);
+
+	pad = -(uintptr_t)arena->top & (align - 1);
+	if (pad > (size_t)(arena->end - arena->top))
+		return 0;
+	arena->top += pad;
+	return arena_alloc(arena, size);
+}
+
+/* Runs in the calling task after every successful event_wait. */
+static void arena_wait_hook(unsigned int dev)
+{
+	arena_t* a;
+
+	for (a = attached; a; a = a->next)
+		if (a->dev == dev)
+			arena_reset(a);
+}
+
+/**
+ * @brief Resets arena every time a task returns from event_wait(dev).
+ *
+ * Tasks share one address space, so attach one arena per device and set
+ * them up from main before task_create.
+ */
+void arena_attach(arena_t* arena, unsigned int dev)
+{
+	arena->dev = dev;
+	arena->next = attached;
+	attached = arena;
+	event_wait_hook = arena_wait_hook;
+}
+
+/**
+ * @brief Stops resetting arena from event_wait.
+ */
+void arena_detach(arena_t* arena)
+{
+	arena_t** link;
+
+	for (link = &attached; *link; link = &(*link)->next)
+		if (*link == arena) {
+			*link = arena->next;
+			break;
+		}
+	arena->next = 0;
+	if (!attached)
+		event_wait_hook = 0;
+}
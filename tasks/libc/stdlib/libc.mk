@@ -1,3 +1,4 @@
-TLIBC_STDLIB_OBJS := errno.o ctype.o atoi.o strtol.o strtoul.o rand.o
+TLIBC_STDLIB_OBJS := errno.o ctype.o atoi.o strtol.o strtoul.o rand.o \
+	tlsf.o malloc.o arena.o time.o ring.o
 TLIBC_STDLIB_OBJS := $(TLIBC_STDLIB_OBJS:%=$(TLIBCDIR)/stdlib/%)
 TLIBC_OBJS += $(TLIBC_STDLIB_OBJS)
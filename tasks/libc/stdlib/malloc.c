@@ -0,0 +1,60 @@
+/** @file malloc.c
+ *
+ * @brief malloc and free over a task-supplied TLSF heap.
+ *
+ * There is no sbrk -- a task hands malloc_init the region it wants managed,
+ * typically a block of SDRAM it would otherwise carve up by hand.  Both
+ * calls inherit the constant-time bound of the underlying heap.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <heap.h>
+
+static heap_t* malloc_heap;
+
+/**
+ * @brief Makes [mem, mem + bytes) the heap behind malloc and free.
+ *
+ * @return 0 on success, -1 with errno set to EINVAL if the region is too
+ *         small to hold a heap.
+ */
+int malloc_init(void* mem, size_t bytes)
+{
+	heap_t* heap = heap_init(mem, bytes);
+
+	if (!heap) {
+		errno = EINVAL;
+		return -1;
+	}
+	malloc_heap = heap;
+	return 0;
+}
+
+/**
+ * @brief Returns the heap set up by malloc_init, or 0 if there is none.
+ */
+heap_t* malloc_get_heap(void)
+{
+	return malloc_heap;
+}
+
+void* malloc(size_t size)
+{
+	void* p;
+
+	if (!malloc_heap) {
+		errno = ENOMEM;
+		return 0;
+	}
+	p = heap_alloc(malloc_heap, size);
+	if (!p && size)
+		errno = ENOMEM;
+	return p;
+}
+
+void free(void* ptr)
+{
+	if (ptr)
+		heap_free(malloc_heap, ptr);
+}
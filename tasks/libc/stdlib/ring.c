@@ -0,0 +1,33 @@
+/** @file ring.c
+ *
+ * @brief Syscall ring setup.
+ *
+ * The submission and completion fast paths live in ring.h; this file holds
+ * the library copies of the inline functions.
+ */
+
+#define IMPLEMENTATION
+#include <ring.h>
+
+/**
+ * @brief Lays a ring over entries submission and completion slots and
+ * registers it with the kernel for the calling task.
+ *
+ * entries must be a power of two no larger than RING_MAX_ENTRIES.  Call this
+ * from the task that will use the ring; each task has at most one.
+ *
+ * @return 0 on success, or -1 with errno set.
+ */
+int ring_init(struct ring* ring, struct ring_sqe* sqes, struct ring_cqe* cqes,
+	unsigned long entries, unsigned long flags)
+{
+	ring->sq_head = 0;
+	ring->sq_tail = 0;
+	ring->cq_head = 0;
+	ring->cq_tail = 0;
+	ring->entries = entries;
+	ring->flags = flags;
+	ring->sqes = sqes;
+	ring->cqes = cqes;
+	return ring_setup(ring);
+}
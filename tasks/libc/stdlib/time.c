@@ -0,0 +1,106 @@
+/** @file time.c
+ *
+ * @brief Clocks that read the kernel's time page -- no syscall.
+ *
+ * Every reader snapshots the tick fields and the OS timer count under the
+ * page's sequence lock.  The count is clamped to just under one tick so
+ * that time never appears to run backwards between the timer match and the kernel
+ * handling the tick.  Conversions are multiplies by the page's precomputed
+ * reciprocals.
+ */
+
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <bits/time_page.h>
+
+struct snapshot
+{
+	unsigned long ticks, ticks_hi;  /* 64-bit tick count */
+	unsigned long sec, sec_ticks;   /* the same instant split at seconds */
+	unsigned long count;            /* OS timer count since the tick */
+};
+
+static void snapshot(struct snapshot* s)
+{
+	const struct time_page* page = TIME_PAGE;
+	unsigned long seq;
+
+	do {
+		seq = page->seq;
+		s->ticks = page->ticks;
+		s->ticks_hi = page->ticks_hi;
+		s->sec = page->sec;
+		s->sec_ticks = page->sec_ticks;
+		s->count = *(volatile unsigned long*)page->oscr_addr;
+	} while ((seq & 1) || seq != page->seq);
+
+	if (s->count >= page->oscr_per_tick)
+		s->count = page->oscr_per_tick - 1;
+}
+
+static uint64_t snapshot_ticks(const struct snapshot* s)
+{
+	return ((uint64_t)s->ticks_hi << 32) | s->ticks;
+}
+
+/**
+ * @brief Milliseconds since boot.
+ */
+unsigned long time(void)
+{
+	return TIME_PAGE->ticks * TIME_PAGE->ms_per_tick;
+}
+
+/**
+ * @brief Microseconds since boot, truncated to 32 bits.
+ */
+unsigned long time_us(void)
+{
+	return (unsigned long)clock_us();
+}
+
+/**
+ * @brief Monotonic nanoseconds since boot.
+ */
+uint64_t clock_ns(void)
+{
+	struct snapshot s;
+
+	snapshot(&s);
+	return snapshot_ticks(&s) * TIME_PAGE->ns_per_tick
+		+ (((uint64_t)s.count * TIME_PAGE->oscr_ns_mult) >> 16);
+}
+
+/**
+ * @brief Monotonic microseconds since boot.
+ */
+uint64_t clock_us(void)
+{
+	struct snapshot s;
+
+	snapshot(&s);
+	return snapshot_ticks(&s) * TIME_PAGE->us_per_tick
+		+ (((uint64_t)s.count * TIME_PAGE->oscr_us_mult) >> 32);
+}
+
+/**
+ * @brief Reads CLOCK_MONOTONIC as seconds and nanoseconds.
+ *
+ * @return 0, or -1 with errno set to EINVAL for any other clock.
+ */
+int clock_gettime(clockid_t clock, struct timespec* ts)
+{
+	struct snapshot s;
+
+	if (clock != CLOCK_MONOTONIC) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	snapshot(&s);
+	ts->tv_sec = s.sec;
+	ts->tv_nsec = s.sec_ticks * TIME_PAGE->ns_per_tick
+		+ (unsigned long)(((uint64_t)s.count * TIME_PAGE->oscr_ns_mult) >> 16);
+	return 0;
+}
@@ -0,0 +1,334 @@
+/** @file tlsf.c
+ *
+ * @brief Two-Level Segregated Fit allocator (Masmano et al., 2004).
+ *
+ * Free blocks are binned by size.  The first level splits sizes by powers of
+ * two and the second level splits each power of two into SL_COUNT linear
+ * ranges.  One bit per non-empty list is kept in fl_bitmap and sl_bitmap, so
+ * finding a list that satisfies a request is two find-first-set operations,
+ * and splitting and coalescing with physical neighbours touch a bounded
+ * number of blocks.  Every path through heap_alloc and heap_free is O(1).
+ *
+ * Block layout (all sizes are multiples of ALIGN_SIZE):
+ *
+ *   +-----------+------+----------------------------------+
+ *   | prev_phys | size | payload (next_free/prev_free)    |
+ *   +-----------+------+----------------------------------+
+ *
+ * prev_phys is only meaningful while the preceding block is free
+ * (BLOCK_PREV_FREE).  A zero-sized used block terminates the region so the
+ * last real block always has a successor.
+ */
+
+#include <heap.h>
+
+#define ALIGN_LOG2       3
+#define ALIGN_SIZE       (1u << ALIGN_LOG2)
+
+#define SL_LOG2          4
+#define SL_COUNT         (1u << SL_LOG2)
+#define FL_SHIFT         (SL_LOG2 + ALIGN_LOG2)
+#define FL_MAX           30
+#define FL_COUNT         (FL_MAX - FL_SHIFT + 1)
+#define SMALL_BLOCK      (1u << FL_SHIFT)
+
+#define BLOCK_FREE       0x1u
+#define BLOCK_PREV_FREE  0x2u
+#define BLOCK_FLAGS      (BLOCK_FREE | BLOCK_PREV_FREE)
+
+#define BLOCK_HDR        offsetof(block_t, next_free)
+#define BLOCK_MIN        (sizeof(block_t) - BLOCK_HDR)
+#define BLOCK_MAX        (1u << (FL_MAX - 1))
+
+typedef struct block
+{
+	struct block* prev_phys;   /**< Preceding block, valid if it is free */
+	size_t        size;        /**< Payload bytes | BLOCK_FLAGS */
+	struct block* next_free;   /**< Free list links -- overlay the payload */
+	struct block* prev_free;
+} block_t;
+
+struct heap
+{
+	uint32_t     fl_bitmap;
+	uint32_t     sl_bitmap[FL_COUNT];
+	block_t*     blocks[FL_COUNT][SL_COUNT];
+	size_t       size;
+	size_t       used;
+	size_t       high_water;
+};
+
+/* Index of the highest set bit; x must be non-zero. */
+static inline unsigned int fls_bit(uint32_t x)
+{
+	return 31 - __builtin_clz(x);
+}
+
+/* Index of the lowest set bit; x must be non-zero. */
+static inline unsigned int ffs_bit(uint32_t x)
+{
+	return fls_bit(x & -x);
+}
+
+static inline size_t block_size(const block_t* b)
+{
+	return b->size & ~BLOCK_FLAGS;
+}
+
+static inline block_t* block_next(const block_t* b)
+{
+	return (block_t*)((char*)b + BLOCK_HDR + block_size(b));
+}
+
+static inline void* block_payload(const block_t* b)
+{
+	return (char*)b + BLOCK_HDR;
+}
+
+static inline block_t* payload_block(const void* p)
+{
+	return (block_t*)((char*)p - BLOCK_HDR);
+}
+
+/* First- and second-level list holding blocks of exactly this size. */
+static void mapping_insert(size_t size, unsigned int* fl, unsigned int* sl)
+{
+	unsigned int f;
+
+	if (size < SMALL_BLOCK) {
+		*fl = 0;
+		*sl = size / (SMALL_BLOCK / SL_COUNT);
+	} else {
+		f = fls_bit(size);
+		*sl = (size >> (f - SL_LOG2)) ^ SL_COUNT;
+		*fl = f - (FL_SHIFT - 1);
+	}
+}
+
+/* Like mapping_insert, but rounds up so every block in the list fits. */
+static void mapping_search(size_t size, unsigned int* fl, unsigned int* sl)
+{
+	if (size >= SMALL_BLOCK)
+		size += (1u << (fls_bit(size) - SL_LOG2)) - 1;
+	mapping_insert(size, fl, sl);
+}
+
+static block_t* find_suitable(heap_t* heap, unsigned int* fl, unsigned int* sl)
+{
+	uint32_t sl_map, fl_map;
+
+	sl_map = heap->sl_bitmap[*fl] & (~0u << *sl);
+	if (!sl_map) {
+		fl_map = heap->fl_bitmap & (~0u << (*fl + 1));
+		if (!fl_map)
+			return 0;
+		*fl = ffs_bit(fl_map);
+		sl_map = heap->sl_bitmap[*fl];
+	}
+	*sl = ffs_bit(sl_map);
+
+	return heap->blocks[*fl][*sl];
+}
+
+static void remove_free(heap_t* heap, block_t* b)
+{
+	unsigned int fl, sl;
+
+	mapping_insert(block_size(b), &fl, &sl);
+	if (b->next_free)
+		b->next_free->prev_free = b->prev_free;
+	if (b->prev_free)
+		b->prev_free->next_free = b->next_free;
+	else {
+		heap->blocks[fl][sl] = b->next_free;
+		if (!b->next_free) {
+			heap->sl_bitmap[fl] &= ~(1u << sl);
+			if (!heap->sl_bitmap[fl])
+				heap->fl_bitmap &= ~(1u << fl);
+		}
+	}
+}
+
+static void insert_free(heap_t* heap, block_t* b)
+{
+	unsigned int fl, sl;
+
+	mapping_insert(block_size(b), &fl, &sl);
+	b->prev_free = 0;
+	b->next_free = heap->blocks[fl][sl];
+	if (b->next_free)
+		b->next_free->prev_free = b;
+	heap->blocks[fl][sl] = b;
+	heap->fl_bitmap |= 1u << fl;
+	heap->sl_bitmap[fl] |= 1u << sl;
+}
+
+/* Marks b free and records it as the physical predecessor of its successor. */
+static void mark_free(block_t* b)
+{
+	block_t* next = block_next(b);
+
+	b->size |= BLOCK_FREE;
+	next->prev_phys = b;
+	next->size |= BLOCK_PREV_FREE;
+}
+
+/**
+ * @brief Places a heap over the region [mem, mem + bytes).
+ *
+ * The control structure lives at the start of the region; the rest becomes a
+ * single free block.
+ *
+ * @return The heap, or 0 if the region cannot hold a usable heap.
+ */
+heap_t* heap_init(void* mem, size_t bytes)
+{
+	size_t skew = -(uintptr_t)mem & (ALIGN_SIZE - 1);
+	size_t ctl = (sizeof(heap_t) + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+	heap_t* heap = (heap_t*)((char*)mem + skew);
+	block_t *b, *sentinel;
+	size_t avail;
+	unsigned int i, j;
+
+	if (bytes < skew + ctl + 2 * BLOCK_HDR + BLOCK_MIN)
+		return 0;
+
+	avail = (bytes - skew - ctl - 2 * BLOCK_HDR) & ~(ALIGN_SIZE - 1);
+	if (avail > BLOCK_MAX)
+		avail = BLOCK_MAX;
+
+	heap->fl_bitmap = 0;
+	for (i = 0; i < FL_COUNT; i++) {
+		heap->sl_bitmap[i] = 0;
+		for (j = 0; j < SL_COUNT; j++)
+			heap->blocks[i][j] = 0;
+	}
+	heap->size = avail + 2 * BLOCK_HDR;
+	heap->used = 0;
+	heap->high_water = 0;
+
+	b = (block_t*)((char*)heap + ctl);
+	b->prev_phys = 0;
+	b->size = avail;
+	sentinel = block_next(b);
+	sentinel->size = 0;
+	mark_free(b);
+	insert_free(heap, b);
+
+	return heap;
+}
+
+/**
+ * @brief Allocates size bytes, aligned to 8, from the heap in O(1).
+ *
+ * @return The payload pointer, or 0 if size is 0 or no block fits.
+ */
+void* heap_alloc(heap_t* heap, size_t size)
+{
+	unsigned int fl, sl;
+	block_t *b, *rest;
+	size_t total;
+
+	if (size == 0 || size > BLOCK_MAX)
+		return 0;
+	size = (size + ALIGN_SIZE - 1) & ~(ALIGN_SIZE - 1);
+	if (size < BLOCK_MIN)
+		size = BLOCK_MIN;
+
+	mapping_search(size, &fl, &sl);
+	b = fl < FL_COUNT ? find_suitable(heap, &fl, &sl) : 0;
+	if (!b) {
+		/* The rounded-up lists are empty, but the head of the list the
+		 * size itself falls in may still be big enough. */
+		mapping_insert(size, &fl, &sl);
+		b = heap->blocks[fl][sl];
+		if (!b || block_size(b) < size)
+			return 0;
+	}
+	remove_free(heap, b);
+
+	/* Split off the tail if it can stand as a block of its own. */
+	if (block_size(b) >= size + BLOCK_HDR + BLOCK_MIN) {
+		rest = (block_t*)((char*)block_payload(b) + size);
+		rest->size = block_size(b) - size - BLOCK_HDR;
+		b->size = size | (b->size & BLOCK_FLAGS);
+		mark_free(rest);
+		insert_free(heap, rest);
+	}
+
+	b->size &= ~BLOCK_FREE;
+	block_next(b)->size &= ~BLOCK_PREV_FREE;
+
+	total = block_size(b) + BLOCK_HDR;
+	heap->used += total;
+	if (heap->used > heap->high_water)
+		heap->high_water = heap->used;
+
+	return block_payload(b);
+}
+
+/**
+ * @brief Returns a block to the heap in O(1), merging it with free physical
+ * neighbours.  Freeing 0 does nothing.
+ */
+void heap_free(heap_t* heap, void* ptr)
+{
+	block_t *b, *prev, *next;
+
+	if (!ptr)
+		return;
+
+	b = payload_block(ptr);
+	heap->used -= block_size(b) + BLOCK_HDR;
+
+	if (b->size & BLOCK_PREV_FREE) {
+		prev = b->prev_phys;
+		remove_free(heap, prev);
+		prev->size += BLOCK_HDR + block_size(b);
+		b = prev;
+	}
+
+	next = block_next(b);
+	if (next->size & BLOCK_FREE) {
+		remove_free(heap, next);
+		b->size += BLOCK_HDR + block_size(next);
+	}
+
+	mark_free(b);
+	insert_free(heap, b);
+}
+
+/**
+ * @brief Reports usage and fragmentation of the heap.
+ *
+ * Unlike allocation, this walks every free list and is linear in the number
+ * of free blocks.  Keep it out of time-critical paths.
+ */
+void heap_stats(heap_t* heap, heap_stats_t* stats)
+{
+	unsigned int fl, sl, shift;
+	block_t* b;
+
+	stats->size = heap->size;
+	stats->used = heap->used;
+	stats->high_water = heap->high_water;
+	stats->free = 0;
+	stats->largest_free = 0;
+	stats->free_blocks = 0;
+
+	for (fl = 0; fl < FL_COUNT; fl++) {
+		for (sl = 0; sl < SL_COUNT; sl++) {
+			for (b = heap->blocks[fl][sl]; b; b = b->next_free) {
+				stats->free += block_size(b);
+				stats->free_blocks++;
+				if (block_size(b) > stats->largest_free)
+					stats->largest_free = block_size(b);
+			}
+		}
+	}
+
+	/* Scale big heaps down so the percentage fits in 32 bits. */
+	shift = (stats->free >> 24) ? 8 : 0;
+	stats->fragmentation = stats->free ? 100 - ((stats->largest_free >> shift)
+		* 100) / (stats->free >> shift) : 0;
+}
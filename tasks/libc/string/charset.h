@@ -0,0 +1,33 @@
+/** @file charset.h
+ *
+ * @brief Internal 256-bit character membership bitmap for the span and
+ *        break routines.
+ *
+ * Building the map costs one pass over the set; each lookup afterwards is a
+ * shift and a mask, so scanning is O(n + m) instead of O(n * m).
+ */
+
+#ifndef _STRING_CHARSET_H_
+#define _STRING_CHARSET_H_
+
+#include <sys/types.h>
+
+typedef uint32_t charset_t[256 / 32];
+
+#define CHARSET_BIT(c)     (1u << ((unsigned char)(c) & 31))
+#define CHARSET_WORD(c)    ((unsigned char)(c) >> 5)
+#define CHARSET_ADD(m, c)  ((m)[CHARSET_WORD(c)] |= CHARSET_BIT(c))
+#define CHARSET_HAS(m, c)  ((m)[CHARSET_WORD(c)] & CHARSET_BIT(c))
+
+/* Marks every character of s, excluding its terminator. */
+static inline void charset_init(charset_t map, const char *s)
+{
+	unsigned int i;
+
+	for (i = 0; i < sizeof(charset_t) / sizeof(map[0]); i++)
+		map[i] = 0;
+	for (; *s; s++)
+		CHARSET_ADD(map, *s);
+}
+
+#endif /* _STRING_CHARSET_H_ */
@@ -20,9 +20,38 @@
  */
 
 #include <string.h>
+#include "word.h"
 
 char *strchr(const char *s, int c)
 {
+	const word_t *w;
+	word_t pat, v;
+
+	/*
+	 * A char compared against c is promoted, so a c that is not the value of
+	 * some char never matches and only the terminator ends the search.
+	 */
+	if ((char)c != c)
+		return 0;
+
+	for (; !WORD_ALIGNED(s); s++)
+	{
+		if (*s == c)
+			return (char*)s;
+		if (*s == 0)
+			return 0;
+	}
+
+	/* Skip words that contain neither the terminator nor c. */
+	pat = WORD_REPEAT(c);
+	for (w = (const word_t *)s; ; w++)
+	{
+		v = *w;
+		if (WORD_HAS_ZERO(v) || WORD_HAS_ZERO(v ^ pat))
+			break;
+	}
+
+	s = (const char *)w;
 	while (1)
 	{
 		if (*s == c)
@@ -43,14 +43,37 @@
  *  It returns < 0 if the first differing character is smaller 
  *  in s1 than in s2 or if s1 is shorter than s2 and the
  *  contents are identical upto the length of s1.
+ *
+ *  When both strings share an alignment, equal words without a terminator
+ *  are skipped a word at a time before the byte loop finds the result.
  */
 
 #include <string.h>
+#include "word.h"
 
 int strcmp(const char *s1, const char *s2)
 {
 	unsigned int a, b;
+	const word_t *w1, *w2;
+
+	if (((uintptr_t)s1 & WORD_MASK) == ((uintptr_t)s2 & WORD_MASK))
+	{
+		for (; !WORD_ALIGNED(s1); s1++, s2++)
+			if (*s1 != *s2 || *s1 == 0)
+				goto bytes;
+
+		w1 = (const word_t *)s1;
+		w2 = (const word_t *)s2;
+		while (*w1 == *w2 && !WORD_HAS_ZERO(*w1))
+		{
+			w1++;
+			w2++;
+		}
+		s1 = (const char *)w1;
+		s2 = (const char *)w2;
+	}
 
+bytes:
 	while ( (a = *s1++), (b = *s2++), a && b)
 	{
 		if (a != b)
@@ -38,13 +38,33 @@
  *  strcpy copies the contents of the string "from" including 
  *  the null terminator to the string "to". A pointer to "to"
  *  is returned.
+ *
+ *  When source and destination share an alignment, whole words without a
+ *  terminator are copied a word at a time.
  */
 
 #include <string.h>
+#include "word.h"
 
 char* strcpy(char *to, const char *from)
 {
 	char *ret = to;
+	word_t *wt;
+	const word_t *wf;
+
+	if (((uintptr_t)to & WORD_MASK) == ((uintptr_t)from & WORD_MASK))
+	{
+		for (; !WORD_ALIGNED(from); to++, from++)
+			if ((*to = *from) == 0)
+				return ret;
+
+		wt = (word_t *)to;
+		wf = (const word_t *)from;
+		while (!WORD_HAS_ZERO(*wf))
+			*wt++ = *wf++;
+		to = (char *)wt;
+		from = (const char *)wf;
+	}
 
 	while ((*to++ = *from++) != 0);
 
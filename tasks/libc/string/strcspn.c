@@ -42,26 +42,24 @@
  */
 
 #include <string.h>
+#include "charset.h"
 
 /*
  * Span the complement of string s2.
  */
 size_t strcspn(const char *s1, const char *s2)
 {
-	const char *p, *spanp;
-	char c, sc;
+	const char *p;
+	charset_t reject;
 
 	/*
 	 * Stop as soon as we find any character from s2.  Note that there
 	 * must be a NUL in s2; it suffices to stop when we find that, too.
 	 */
-	for (p = s1;;) {
-		c = *p++;
-		spanp = s2;
-		do {
-			if ((sc = *spanp++) == c)
-				return (p - 1 - s1);
-		} while (sc != 0);
-	}
-	/* NOTREACHED */
+	charset_init(reject, s2);
+	CHARSET_ADD(reject, '\0');
+
+	for (p = s1; !CHARSET_HAS(reject, *p); p++)
+		;
+	return (p - s1);
 }
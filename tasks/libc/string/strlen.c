@@ -37,15 +37,29 @@
  * Abstract:
  *  strlen returns the number of characters in "string" preceeding 
  *  the terminating null character.
+ *
+ *  Scans a word at a time once the pointer is word aligned.
  */
 
 #include <string.h>
+#include "word.h"
 
 size_t strlen(const char *string)
 {
-	const char *ret = string;
+	const char *s = string;
+	const word_t *w;
+
+	/* Byte-wise up to the first word boundary. */
+	for (; !WORD_ALIGNED(s); s++)
+		if (*s == '\0')
+			return s - string;
+
+	/* One load per word until a word holds the terminator. */
+	for (w = (const word_t *)s; !WORD_HAS_ZERO(*w); w++)
+		;
 
-	while (*string++);
+	for (s = (const char *)w; *s; s++)
+		;
 
-	return string - 1 - ret;
+	return s - string;
 }
@@ -39,19 +39,21 @@
  */
 
 #include <string.h>
+#include "charset.h"
 
 /*
  * Find the first occurrence in s1 of a character in s2 (excluding NUL).
  */
 char* strpbrk(const char* s1, const char* s2)
 {
-	const char *scanp;
-	int c, sc;
+	charset_t accept;
+	char c;
+
+	charset_init(accept, s2);
 
 	while ((c = *s1++) != 0) {
-		for (scanp = s2; (sc = *scanp++) != 0;)
-			if (sc == c)
-				return ((char *)(s1 - 1));
+		if (CHARSET_HAS(accept, c))
+			return ((char *)(s1 - 1));
 	}
 	return 0;
 }
@@ -39,22 +39,22 @@
  */
 
 #include <string.h>
+#include "charset.h"
 
 /*
  * Span the string s2 (skip characters that are in s2).
  */
 size_t strspn(const char *s1, const char *s2)
 {
-	const char *p = s1, *spanp;
-	char c, sc;
+	const char *p;
+	charset_t accept;
 
 	/*
 	 * Skip any characters in s2, excluding the terminating \0.
 	 */
-cont:
-	c = *p++;
-	for (spanp = s2; (sc = *spanp++) != 0;)
-		if (sc == c)
-			goto cont;
-	return (p - 1 - s1);
+	charset_init(accept, s2);
+
+	for (p = s1; CHARSET_HAS(accept, *p); p++)
+		;
+	return (p - s1);
 }
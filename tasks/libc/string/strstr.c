@@ -16,21 +16,145 @@
  * improvements that they make and grant CSL redistribution rights.
  */
 
+/*
+ * Two-Way string matching (Crochemore and Perrin, 1991).  The needle is split
+ * at a critical factorization; the right half is matched left to right and
+ * the left half right to left, and the known period of the needle bounds every
+ * shift.  Linear in the haystack, constant space.
+ */
+
 #include <string.h>
 
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/*
+ * Computes the maximal suffix of the needle under one ordering of the
+ * alphabet (or its reverse) and returns its start minus one, with the period
+ * of that suffix in *period.  (size_t)-1 stands for "before the needle".
+ */
+static size_t max_suffix(const unsigned char *needle, size_t nlen,
+                         int reverse, size_t *period)
+{
+	size_t ms = (size_t)-1, j = 0, k = 1, p = 1;
+	unsigned char a, b;
+
+	while (j + k < nlen)
+	{
+		a = needle[j + k];
+		b = needle[ms + k];
+		if (reverse ? (a > b) : (a < b))
+		{
+			j += k;
+			k = 1;
+			p = j - ms;
+		}
+		else if (a == b)
+		{
+			if (k != p)
+				k++;
+			else
+			{
+				j += p;
+				k = 1;
+			}
+		}
+		else
+		{
+			ms = j++;
+			k = p = 1;
+		}
+	}
+
+	*period = p;
+	return ms;
+}
+
+static int prefix_repeats(const unsigned char *needle, size_t period,
+                          size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		if (needle[i] != needle[i + period])
+			return 0;
+	return 1;
+}
+
 char *strstr(const char *haystack, const char *needle)
 {
-	int hlen = strlen(haystack);
-	int nlen = strlen(needle);
+	const unsigned char *h = (const unsigned char *)haystack;
+	const unsigned char *n = (const unsigned char *)needle;
+	size_t hlen, nlen, suffix, period, rperiod, memory, i, j;
+
+	if (needle[0] == '\0')
+		return (char *)haystack;
+	if (needle[1] == '\0')
+		return strchr(haystack, needle[0]);
+
+	nlen = strlen(needle);
+	hlen = strlen(haystack);
+	if (hlen < nlen)
+		return 0;
 
-	while (hlen >= nlen)
+	/* The critical factorization is the later of the two maximal suffixes. */
+	suffix = max_suffix(n, nlen, 0, &period);
+	i = max_suffix(n, nlen, 1, &rperiod);
+	if (i + 1 > suffix + 1)
 	{
-		if (!memcmp(haystack, needle, nlen))
-			return (void*)haystack;
+		suffix = i;
+		period = rperiod;
+	}
+	suffix++;
 
-		haystack++;
-		hlen--;
+	j = 0;
+	if (prefix_repeats(n, period, suffix))
+	{
+		/* Periodic needle: remember how much of the left half matched. */
+		memory = 0;
+		while (j <= hlen - nlen)
+		{
+			i = MAX(suffix, memory);
+			while (i < nlen && n[i] == h[i + j])
+				i++;
+			if (i >= nlen)
+			{
+				i = suffix - 1;
+				while (memory < i + 1 && n[i] == h[i + j])
+					i--;
+				if (i + 1 < memory + 1)
+					return (char *)(h + j);
+				j += period;
+				memory = nlen - period;
+			}
+			else
+			{
+				j += i - suffix + 1;
+				memory = 0;
+			}
+		}
+	}
+	else
+	{
+		/* Non-periodic needle: any mismatch in the left half skips far. */
+		period = MAX(suffix, nlen - suffix) + 1;
+		while (j <= hlen - nlen)
+		{
+			i = suffix;
+			while (i < nlen && n[i] == h[i + j])
+				i++;
+			if (i >= nlen)
+			{
+				i = suffix - 1;
+				while (i != (size_t)-1 && n[i] == h[i + j])
+					i--;
+				if (i == (size_t)-1)
+					return (char *)(h + j);
+				j += period;
+			}
+			else
+				j += i - suffix + 1;
+		}
 	}
+
 	return 0;
 }
-
@@ -0,0 +1,29 @@
+/** @file word.h
+ *
+ * @brief Internal helpers for the word-at-a-time string routines.
+ *
+ * The zero-byte test is the usual one: for a 32-bit word w,
+ * (w - 0x01010101) & ~w & 0x80808080 is non-zero iff some byte of w is zero.
+ * It never reports a false positive, so a clear result lets the caller skip
+ * the whole word.  A word-aligned load never crosses a page, so reading the
+ * bytes that follow a NUL inside the same word is harmless.
+ */
+
+#ifndef _STRING_WORD_H_
+#define _STRING_WORD_H_
+
+#include <sys/types.h>
+
+/* May alias any other type -- we read char arrays through it. */
+typedef uint32_t __attribute__((may_alias)) word_t;
+
+#define WORD_SIZE         sizeof(word_t)
+#define WORD_MASK         (WORD_SIZE - 1)
+#define WORD_ONES         0x01010101u
+#define WORD_HIGHS        0x80808080u
+
+#define WORD_ALIGNED(p)   (((uintptr_t)(p) & WORD_MASK) == 0)
+#define WORD_HAS_ZERO(w)  (((w) - WORD_ONES) & ~(w) & WORD_HIGHS)
+#define WORD_REPEAT(c)    ((word_t)(unsigned char)(c) * WORD_ONES)
+
+#endif /* _STRING_WORD_H_ */
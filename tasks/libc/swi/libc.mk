@@ -1,3 +1,5 @@
-TLIBC_SWI_OBJS := read.o write.o time.o sleep.o event_wait.o mutex_create.o mutex_unlock.o mutex_lock.o task_create.o
+TLIBC_SWI_OBJS := read.o write.o readv.o writev.o sleep.o event_wait.o event_wait_mask.o \
+	event_wait_timeout.o read_timeout.o mutex_lock_timeout.o mutex_create.o mutex_unlock.o mutex_lock.o task_create.o \
+	stack_usage.o ring_setup.o ring_enter.o fcntl.o poll.o
 TLIBC_SWI_OBJS := $(TLIBC_SWI_OBJS:%=$(TLIBCDIR)/swi/%)
 TLIBC_OBJS += $(TLIBC_SWI_OBJS)
@@ -11,7 +11,8 @@
 #include <task.h>
 #include <unistd.h>
 
-unsigned int *x = 0xa2fffaf0;
+unsigned int shared;
+unsigned int *x = &shared;
 int mutex = -1;
 
 void panic(const char* str)
@@ -81,12 +82,16 @@ int main(int argc, char** argv)
 	tasks[0].stack_pos = (void*)0xa2000000;
 	tasks[0].C = 1;
 	tasks[0].T = PERIOD_DEV0;
+	tasks[0].kstack_size = 0;
+	tasks[0].ustack_size = 0;
 	
 	tasks[1].lambda = fun2;
 	tasks[1].data = (void*)'#';
 	tasks[1].stack_pos = (void*)0xa1000000;
 	tasks[1].C = 1;
 	tasks[1].T = PERIOD_DEV1;
+	tasks[1].kstack_size = 0;
+	tasks[1].ustack_size = 0;
 	
 	puts("gonna call task create");
 	task_create(tasks, 2);
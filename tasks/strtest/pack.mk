@@ -0,0 +1,26 @@
+PROGS_STRTEST_OBJS := strtest.o
+PROGS_STRTEST_OBJS := $(PROGS_STRTEST_OBJS:%=$(TDIR)/strtest/%)
+ALL_OBJS += $(PROGS_STRTEST_OBJS)
+
+$(TDIR)/bin/strtest : $(TSTART) $(PROGS_STRTEST_OBJS) $(TLIBC)
+
+# The same harness links natively against the libc string sources so the word
+# routines can be fuzzed on the development machine:  make strtest-host
+STRTEST_HOST := $(TDIR)/bin/strtest-host
+STRTEST_HOST_SRCS := $(TDIR)/strtest/strtest.c \
+	$(TLIBCDIR)/string/strlen.c $(TLIBCDIR)/string/strchr.c \
+	$(TLIBCDIR)/string/strcmp.c $(TLIBCDIR)/string/strcpy.c \
+	$(TLIBCDIR)/string/strstr.c $(TLIBCDIR)/string/strspn.c \
+	$(TLIBCDIR)/string/strcspn.c $(TLIBCDIR)/string/strpbrk.c
+ALL_CLOBBERS += $(STRTEST_HOST)
+
+.PHONY: strtest-host
+strtest-host: $(STRTEST_HOST)
+	@echo RUN $(notdir $<)
+	@$<
+
+$(STRTEST_HOST): $(STRTEST_HOST_SRCS) $(TLIBCDIR)/string/word.h \
+		$(TLIBCDIR)/string/charset.h
+	@echo HOSTCC $(notdir $@)
+	@mkdir -p $(dir $@)
+	@$(HOSTCC) $(HOSTCFLAGS) -I$(TLIBCDIR)/include -o $@ $(STRTEST_HOST_SRCS)
@@ -0,0 +1,294 @@
+/** @file strtest.c
+ *
+ * @brief Fuzzes the optimized string routines against the naive reference
+ *        copies they replaced.
+ *
+ * Strings of random length and content are placed at every alignment in
+ * both arguments, and each libc routine must return exactly what its naive
+ * version returns.  Builds as a task package and, through `make strtest-host',
+ * as a native program.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_CASES  20000
+#define MAX_LEN    80
+#define MAX_SKEW   8
+#define BUF_SIZE   (MAX_LEN + MAX_SKEW + 8)
+#define MAX_REPORT 10
+
+static char src1[BUF_SIZE], src2[BUF_SIZE];
+static char dst1[BUF_SIZE], dst2[BUF_SIZE];
+static int failures;
+
+/* The byte-at-a-time versions the word routines replaced. */
+
+static size_t byte_strlen(const char *string)
+{
+	const char *ret = string;
+
+	while (*string++);
+
+	return string - 1 - ret;
+}
+
+static char *byte_strchr(const char *s, int c)
+{
+	while (1)
+	{
+		if (*s == c)
+			return (char*)s;
+		if (*s == 0)
+			return 0;
+		s++;
+	}
+}
+
+static int byte_strcmp(const char *s1, const char *s2)
+{
+	unsigned int a, b;
+
+	while ( (a = *s1++), (b = *s2++), a && b)
+	{
+		if (a != b)
+			return (a-b);
+	}
+
+	return a-b;
+}
+
+static char *byte_strcpy(char *to, const char *from)
+{
+	char *ret = to;
+
+	while ((*to++ = *from++) != 0);
+
+	return ret;
+}
+
+static char *naive_strstr(const char *haystack, const char *needle)
+{
+	size_t hlen = byte_strlen(haystack);
+	size_t nlen = byte_strlen(needle);
+	size_t i;
+
+	for (; hlen >= nlen; haystack++, hlen--)
+	{
+		for (i = 0; i < nlen && haystack[i] == needle[i]; i++)
+			;
+		if (i == nlen)
+			return (char*)haystack;
+	}
+	return 0;
+}
+
+static size_t naive_strspn(const char *s1, const char *s2)
+{
+	const char *p = s1, *spanp;
+	char c, sc;
+
+cont:
+	c = *p++;
+	for (spanp = s2; (sc = *spanp++) != 0;)
+		if (sc == c)
+			goto cont;
+	return (p - 1 - s1);
+}
+
+static size_t naive_strcspn(const char *s1, const char *s2)
+{
+	const char *p, *spanp;
+	char c, sc;
+
+	for (p = s1;;) {
+		c = *p++;
+		spanp = s2;
+		do {
+			if ((sc = *spanp++) == c)
+				return (p - 1 - s1);
+		} while (sc != 0);
+	}
+}
+
+static char *naive_strpbrk(const char* s1, const char* s2)
+{
+	const char *scanp;
+	int c, sc;
+
+	while ((c = *s1++) != 0) {
+		for (scanp = s2; (sc = *scanp++) != 0;)
+			if (sc == c)
+				return ((char *)(s1 - 1));
+	}
+	return 0;
+}
+
+static void fail(int n, const char *what, long got, long want)
+{
+	if (failures++ < MAX_REPORT)
+		printf("case %d: %s returned %ld, expected %ld\n", n, what, got, want);
+}
+
+/* Fills a string of len random non-zero bytes, high bytes included. */
+static char *random_string(char *buf, size_t skew, size_t len)
+{
+	size_t i;
+	char *s = buf + skew;
+
+	for (i = 0; i < len; i++)
+		s[i] = (char)(rand() % 255 + 1);
+	s[len] = '\0';
+
+	return s;
+}
+
+/* Draws from a tiny alphabet so that matches and periodic needles are common. */
+static char *small_string(char *buf, size_t skew, size_t len, int alphabet)
+{
+	size_t i;
+	char *s = buf + skew;
+
+	for (i = 0; i < len; i++)
+		s[i] = (rand() % 16) ? 'a' + rand() % alphabet : (char)0xe9;
+	s[len] = '\0';
+
+	return s;
+}
+
+static long offset(const char *p, const char *base)
+{
+	return p ? p - base : -1;
+}
+
+static void test_search(int n)
+{
+	int alphabet = rand() % 4 + 1;
+	size_t hlen = rand() % MAX_LEN, nlen, start, i;
+	char *h, *nd, *r1, *r2;
+	size_t l1, l2;
+
+	h = small_string(src1, rand() % MAX_SKEW, hlen, alphabet);
+
+	switch (rand() % 3)
+	{
+	case 0:
+		/* A slice of the haystack, sometimes with one byte changed. */
+		start = hlen ? rand() % hlen : 0;
+		nlen = rand() % (hlen - start + 1);
+		nd = src2 + rand() % MAX_SKEW;
+		for (i = 0; i < nlen; i++)
+			nd[i] = h[start + i];
+		nd[nlen] = '\0';
+		if (nlen && rand() % 3 == 0)
+			nd[rand() % nlen] = 'a' + rand() % alphabet;
+		break;
+	case 1:
+		/* A short period repeated, e.g. "abaabaab". */
+		nlen = rand() % 16;
+		nd = src2 + rand() % MAX_SKEW;
+		start = rand() % 3 + 1;
+		for (i = 0; i < nlen; i++)
+			nd[i] = (i < start) ? 'a' + rand() % alphabet : nd[i - start];
+		nd[nlen] = '\0';
+		break;
+	default:
+		nd = small_string(src2, rand() % MAX_SKEW, rand() % 12, alphabet);
+		break;
+	}
+
+	r1 = strstr(h, nd);
+	r2 = naive_strstr(h, nd);
+	if (r1 != r2)
+		fail(n, "strstr", offset(r1, h), offset(r2, h));
+
+	l1 = strspn(h, nd);
+	l2 = naive_strspn(h, nd);
+	if (l1 != l2)
+		fail(n, "strspn", l1, l2);
+
+	l1 = strcspn(h, nd);
+	l2 = naive_strcspn(h, nd);
+	if (l1 != l2)
+		fail(n, "strcspn", l1, l2);
+
+	r1 = strpbrk(h, nd);
+	r2 = naive_strpbrk(h, nd);
+	if (r1 != r2)
+		fail(n, "strpbrk", offset(r1, h), offset(r2, h));
+}
+
+static void test_one(int n)
+{
+	size_t len1 = rand() % MAX_LEN;
+	size_t skew1 = rand() % MAX_SKEW, skew2 = rand() % MAX_SKEW;
+	size_t i, dskew;
+	char *s1, *s2, *r1, *r2;
+	int c;
+
+	s1 = random_string(src1, skew1, len1);
+
+	/* Mostly a near copy of s1 so strcmp walks far before differing. */
+	if (rand() % 4)
+	{
+		s2 = src2 + skew2;
+		byte_strcpy(s2, s1);
+		if (len1 && rand() % 2)
+			s2[rand() % len1] = (char)(rand() % 256);
+		if (rand() % 4 == 0)
+			s2[rand() % (len1 + 1)] = '\0';
+	}
+	else
+		s2 = random_string(src2, skew2, rand() % MAX_LEN);
+
+	if (strlen(s1) != byte_strlen(s1))
+		fail(n, "strlen", strlen(s1), byte_strlen(s1));
+
+	switch (rand() % 4)
+	{
+	case 0:  c = len1 ? s1[rand() % len1] : 'a'; break;
+	case 1:  c = 0; break;
+	case 2:  c = rand() % 256; break;
+	default: c = rand() % 1024 - 512; break;
+	}
+	r1 = strchr(s1, c);
+	r2 = byte_strchr(s1, c);
+	if (r1 != r2)
+		fail(n, "strchr", offset(r1, s1), offset(r2, s1));
+
+	if (strcmp(s1, s2) != byte_strcmp(s1, s2))
+		fail(n, "strcmp", strcmp(s1, s2), byte_strcmp(s1, s2));
+
+	/* Half the time share the source alignment so the word copy runs. */
+	dskew = (rand() % 2) ? skew1 : (size_t)(rand() % MAX_SKEW);
+	for (i = 0; i < BUF_SIZE; i++)
+		dst1[i] = dst2[i] = (char)i;
+	r1 = strcpy(dst1 + dskew, s1);
+	r2 = byte_strcpy(dst2 + dskew, s1);
+	if (r1 - dst1 != r2 - dst2)
+		fail(n, "strcpy", r1 - dst1, r2 - dst2);
+	for (i = 0; i < BUF_SIZE; i++)
+		if (dst1[i] != dst2[i])
+		{
+			fail(n, "strcpy byte", dst1[i], dst2[i]);
+			break;
+		}
+}
+
+int main(int argc, char** argv)
+{
+	int n;
+
+	srand(349);
+	for (n = 0; n < NUM_CASES; n++)
+	{
+		test_one(n);
+		test_search(n);
+	}
+
+	printf("strtest: %d cases, %d failures\n", NUM_CASES, failures);
+
+	argc=argc; /* remove compiler warning */
+	argv[0]=argv[0]; /* remove compiler warning */
+	return failures != 0;
+}
@@ -5,7 +5,7 @@ ALL_CLOBBERS += $(PACKAGES:%=$(TDIR)/%/skyeye.conf) $(PACKAGES:%=$(TDIR)/%/packa
 
 include $(TLIBCDIR)/libc.mk
 
-LIBC_GROUP = --start-group $(TLIBC) $(LIBGCC) --end-group
+LIBC_GROUP = --start-group $(TLIBC) $(TLIBGCC) --end-group
 
 include $(PACKAGE_MKS)
 
@@ -24,5 +24,5 @@ $(TDIR)/%/package.bin : $(TDIR)/bin/%.bin
 
 $(PACKAGE_TARGETS):
 	@echo LD $(notdir $@)
-	@$(LD) -static $(LDFLAGS) -o $@ $^
+	@$(LD) -static $(LDFLAGS) -o $@ $^ $(LIBC_GROUP)
 
@@ -39,12 +39,16 @@ int main(int argc, char** argv)
 	tasks[0].stack_pos = (void*)0xa2000000;
 	tasks[0].C = 1;
 	tasks[0].T = PERIOD_DEV0;
+	tasks[0].kstack_size = 0;
+	tasks[0].ustack_size = 0;
 	
 	tasks[1].lambda = fun1;
 	tasks[1].data = (void*)'#';
 	tasks[1].stack_pos = (void*)0xa1000000;
 	tasks[1].C = 1;
 	tasks[1].T = PERIOD_DEV1;
+	tasks[1].kstack_size = 0;
+	tasks[1].ustack_size = 0;
 	
 	puts("gonna call task create");
 	task_create(tasks, 2);
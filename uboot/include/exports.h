@@ -9,7 +9,8 @@
 /* From common.h: */
 typedef void (interrupt_handler_t)(void *);
 
-/* These are declarations of exported functions available in C code */
+/* These are declarations of exported functions available in C code.  The
+ * console ones, getc to printf and vprintf, are implemented by the kernel. */
 unsigned long get_version(void);
 int  getc(void);
 int  tstc(void);
@@ -4,7 +4,9 @@
  * @brief U-Boot standalone API entry stubs.
  *
  * This file generate assembly stubs that act as a shim-layer between the
- * kernel and u-boot's standalone API routines.
+ * kernel and u-boot's standalone API routines.  The console calls (getc,
+ * tstc, putc, puts, printf, vprintf) are the kernel's own, so what is left
+ * here is only used at boot.
  *
  * @author Mike Kasick <mkasick@andrew.cmu.edu>
  *
@@ -17,15 +19,22 @@
 #define OFFSETOF_JT_IN_GD_T 32
 
 /*
- * r8 holds the pointer to the global_data, ip is a call-clobbered
- * register
+ * the kernel uses r8 like any other register, so load U-Boot's pointer to
+ * the global_data into it around the call, which U-Boot code expects there;
+ * ip is a call-clobbered register.  None of the calls take stack arguments.
  */
 #define EXPORT_FUNC(x) \
 	asm volatile (			\
 "	.globl " #x "\n"		\
 #x ":\n"				\
+"	stmfd	sp!, {r8, lr}\n"	\
+"	ldr	r8, =global_data\n"	\
+"	ldr	r8, [r8]\n"		\
 "	ldr	ip, [r8, %0]\n"		\
-"	ldr	pc, [ip, %1]\n"		\
+"	ldr	ip, [ip, %1]\n"		\
+"	mov	lr, pc\n"		\
+"	mov	pc, ip\n"		\
+"	ldmfd	sp!, {r8, pc}\n"	\
 	: : "i"(OFFSETOF_JT_IN_GD_T), "i"(XF_ ## x * sizeof(void *)) : "ip");
 
 /* This function is necessary to prevent the compiler from
@@ -37,7 +46,17 @@
  */
 static void __attribute__((used, naked)) dummy(void)
 {
-#include <_exports.h>
+EXPORT_FUNC(get_version)
+EXPORT_FUNC(install_hdlr)
+EXPORT_FUNC(free_hdlr)
+EXPORT_FUNC(malloc)
+EXPORT_FUNC(free)
+EXPORT_FUNC(udelay)
+EXPORT_FUNC(get_timer)
+EXPORT_FUNC(do_reset)
+EXPORT_FUNC(getenv)
+EXPORT_FUNC(setenv)
+EXPORT_FUNC(simple_strtoul)
 }
 
 extern unsigned long __bss_start, _end;